@@ -7,7 +7,17 @@ void GCD::Loader::loadKernelModuleIoctlDivision()
     loadKernelModule(getModulePath(getDivisionModuleName()));
 }
 
+void GCD::Loader::loadKernelModuleUtilities()
+{
+    loadKernelModule(getModulePath(getUtilitiesModuleName()));
+}
+
 bool GCD::Loader::isKernelModuleIoctlDivisionLoaded()
 {
     return Utilities::isKernelModuleLoaded(getDivisionModuleName());
 }
+
+bool GCD::Loader::isKernelModuleUtilitiesLoaded()
+{
+    return Utilities::isKernelModuleLoaded(getUtilitiesModuleName());
+}
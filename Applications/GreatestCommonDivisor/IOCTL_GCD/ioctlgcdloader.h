@@ -3,15 +3,24 @@
 #include <string_view>
 
 constexpr std::string_view ioctlDivisionModuleName{"ioctl_division"};
+constexpr std::string_view utilitiesModuleName{"kernel_utilities"};
 
 namespace GCD::Loader
 {
 void loadKernelModuleIoctlDivision();
+void loadKernelModuleUtilities();
+
 bool isKernelModuleIoctlDivisionLoaded();
+bool isKernelModuleUtilitiesLoaded();
 
 constexpr std::string_view getDivisionModuleName()
 {
     return ioctlDivisionModuleName;
 }
 
+constexpr std::string_view getUtilitiesModuleName()
+{
+    return utilitiesModuleName;
+}
+
 } // namespace GCD::Loader
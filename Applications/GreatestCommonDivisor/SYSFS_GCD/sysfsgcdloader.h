@@ -3,7 +3,7 @@
 #include <string_view>
 
 constexpr std::string_view divisionModuleName{"division"};
-constexpr std::string_view utilitiesModuleName{"kernelutilities"};
+constexpr std::string_view utilitiesModuleName{"kernel_utilities"};
 
 namespace GCD::Loader
 {
@@ -15,10 +15,12 @@
      (e.g. sudo ./GreatestCommonDivisor 6 10 # g.c.d. is 2)
 
     Notes:
-    - the application requests loading of the IoctlDivision kernel module so no action is required from user side other
-   that running the app with "sudo" and providing the required arguments (divided and divider)
-    - the kernel module will be left in the same state that it had when the application got opened: if open it will be
-   left open, same for the closed state
+    - the application requests loading of the IoctlDivision and KernelUtilities kernel modules so no action is required
+   from user side other that running the app with "sudo" and providing the required arguments (divided and divider)
+    - the kernel modules will be left in the same state that they had when the application got opened: if a module is
+   open it will be left open, same for the closed state
+    - the KernelUtilities module is used by IoctlDivision (hot path log level) so it should be loaded beforehand; the
+   two modules should be unloaded in reverse order
  */
 
 int main(int argc, char** argv)
@@ -32,6 +34,13 @@ int main(int argc, char** argv)
         {
             Utilities::clearScreen();
 
+            const bool isUtilitiesModuleInitiallyLoaded{GCD::Loader::isKernelModuleUtilitiesLoaded()};
+
+            if (!isUtilitiesModuleInitiallyLoaded)
+            {
+                GCD::Loader::loadKernelModuleUtilities();
+            }
+
             const bool isDivisionModuleInitiallyLoaded{GCD::Loader::isKernelModuleIoctlDivisionLoaded()};
 
             if (!isDivisionModuleInitiallyLoaded)
@@ -69,6 +78,11 @@ int main(int argc, char** argv)
             {
                 Utilities::unloadKernelModule(GCD::Loader::getDivisionModuleName());
             }
+
+            if (!isUtilitiesModuleInitiallyLoaded)
+            {
+                Utilities::unloadKernelModule(GCD::Loader::getUtilitiesModuleName());
+            }
         }
         catch (const std::runtime_error& err)
         {
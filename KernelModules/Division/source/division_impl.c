@@ -2,6 +2,7 @@
 #include <linux/module.h>
 
 #include "division_impl.h"
+#include "kernel_utilities_log.h" // the kernel_utilities module (exporting the log level) should be loaded first
 
 MODULE_LICENSE("GPL");
 
@@ -44,10 +45,8 @@ static int compute_quotient_and_remainder(struct division_data* data)
         memset(data->status, '\0', MAX_STATUS_STR_LENGTH);
         strncpy(data->status, synced_status_str, strlen(synced_status_str));
 
-        pr_info("%s: divided: %d\n", THIS_MODULE->name, data->divided);
-        pr_info("%s: divider: %d\n", THIS_MODULE->name, data->divider);
-        pr_info("%s: quotient: %d\n", THIS_MODULE->name, data->quotient);
-        pr_info("%s: remainder: %d\n", THIS_MODULE->name, data->remainder);
+        hot_path_debug("%s: divided: %d, divider: %d, quotient: %d, remainder: %d\n", THIS_MODULE->name, data->divided,
+                       data->divider, data->quotient, data->remainder);
     } while (false);
 
     return result;
@@ -65,7 +64,7 @@ int init_data(struct division_data* data, int divided, int divider)
         memset(data->status, '\0', MAX_STATUS_STR_LENGTH);
         strncpy(data->status, dirty_status_str, strlen(dirty_status_str));
 
-        pr_info("%s: computing quotient and remainder\n", THIS_MODULE->name);
+        hot_path_info("%s: computing quotient and remainder\n", THIS_MODULE->name);
 
         result = compute_quotient_and_remainder(data);
     }
@@ -104,7 +103,7 @@ int store_divided_value(struct division_data* data, const char* divided_str)
         {
             memset(data->status, '\0', MAX_STATUS_STR_LENGTH);
             strncpy(data->status, dirty_status_str, strlen(dirty_status_str));
-            pr_info("%s: new divided value: %d\n", THIS_MODULE->name, data->divided);
+            hot_path_info("%s: new divided value: %d\n", THIS_MODULE->name, data->divided);
         }
     } while (false);
 
@@ -137,7 +136,7 @@ int store_divider_value(struct division_data* data, const char* divider_str)
         {
             memset(data->status, '\0', MAX_STATUS_STR_LENGTH);
             strncpy(data->status, dirty_status_str, strlen(dirty_status_str));
-            pr_info("%s: new divider value: %d\n", THIS_MODULE->name, data->divider);
+            hot_path_info("%s: new divider value: %d\n", THIS_MODULE->name, data->divider);
         }
     } while (false);
 
@@ -175,18 +174,18 @@ void store_command(struct division_data* data, const char* command_str)
         trim_and_copy_string(data->command, command_str, MAX_COMMAND_STR_LENGTH, THIS_MODULE->name);
         const size_t command_length = strlen(data->command);
 
-        pr_info("%s: issued command: %s\n", THIS_MODULE->name, data->command);
+        hot_path_info("%s: issued command: %s\n", THIS_MODULE->name, data->command);
 
         if (command_length == divide_cmd_str_length &&
             strncmp(data->command, divide_cmd_str, divide_cmd_str_length) == 0)
         {
-            pr_info("%s: computing new quotient and remainder\n", THIS_MODULE->name);
+            hot_path_info("%s: computing new quotient and remainder\n", THIS_MODULE->name);
             compute_quotient_and_remainder(data);
         }
         else if (command_length == reset_cmd_str_length &&
                  strncmp(data->command, reset_cmd_str, reset_cmd_str_length) == 0)
         {
-            pr_info("%s: resetting quotient and remainder\n", THIS_MODULE->name);
+            hot_path_info("%s: resetting quotient and remainder\n", THIS_MODULE->name);
             data->divided = 0;
             data->divider = 1;
             compute_quotient_and_remainder(data);
@@ -5,6 +5,7 @@
 #include <linux/kernel.h>
 
 #include "ioctl_division_impl.h"
+#include "kernel_utilities_log.h" // the kernel_utilities module (exporting the log level) should be loaded first
 
 #define SUCCESS 0
 #define SUPPORTED_MINOR_NUMBERS_COUNT 1
@@ -104,7 +105,7 @@ static int device_open(struct inode* inode, struct file* file)
 
     if (!is_device_open)
     {
-        pr_info("%s: opening device\n", THIS_MODULE->name);
+        hot_path_info("%s: opening device\n", THIS_MODULE->name);
 
         ++is_device_open;
         try_module_get(THIS_MODULE);
@@ -120,7 +121,7 @@ static int device_open(struct inode* inode, struct file* file)
 
 static int device_release(struct inode* inode, struct file* file)
 {
-    pr_info("%s: releasing device\n", THIS_MODULE->name);
+    hot_path_info("%s: releasing device\n", THIS_MODULE->name);
 
     --is_device_open;
     module_put(THIS_MODULE);
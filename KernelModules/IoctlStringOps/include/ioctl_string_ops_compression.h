@@ -0,0 +1,46 @@
+#pragma once
+
+/* Content of a group of data buffer chunks stored LZ4 compressed, never modified once created (the lockless readers
+   might decompress it until released after an SRCU grace period, see call_srcu()).
+*/
+struct compressed_chunks
+{
+    struct rcu_head rcu;
+    size_t size; // number of bytes of compressed data
+    char data[];
+};
+
+/* The chunks are gathered into a contiguous buffer before compression (LZ4 requires contiguous input), the same buffer
+   receiving the decompressed content when reading. The compressed content is first written to a worst case sized
+   buffer and then copied to an exactly sized allocation. Each channel has its own buffers.
+*/
+struct compression_buffers
+{
+    char* uncompressed_buffer;
+    char* output_buffer;
+    void* work_memory;
+    size_t uncompressed_size;
+    size_t compression_bound;
+    const struct compressed_chunks* cached_chunks; // currently decompressed within the uncompressed buffer (or NULL)
+};
+
+// the buffers are sized for the given number of chunks (pages) compressed together
+int allocate_compression_buffers(struct compression_buffers* buffers, size_t chunks_count);
+void free_compression_buffers(struct compression_buffers* buffers);
+
+// returns -E2BIG if compressing doesn't save memory (the chunks should be kept as they are)
+int compress_chunks(struct compression_buffers* buffers, char* const* chunks, size_t chunks_count,
+                    struct compressed_chunks** compressed);
+
+/* The content is decompressed into an internal buffer that acts as a cache for the most recently decompressed chunks
+   group (no decompression performed when reading the same group again). Returns NULL if decompression failed.
+*/
+const char* decompress_chunks(struct compression_buffers* buffers, const struct compressed_chunks* compressed);
+
+// decompresses into a caller provided buffer (no buffers required, e.g. lockless readers), size: uncompressed size
+bool decompress_chunks_to(const struct compressed_chunks* compressed, char* destination, size_t size);
+
+// should be called when a group gets dropped or restored, before it is released (its address might get reused)
+void reset_decompression_cache(struct compression_buffers* buffers);
+
+void release_compressed_chunks(struct compressed_chunks* compressed); // no-op if NULL
@@ -1,24 +1,174 @@
 #pragma once
 
-ssize_t device_read_impl(struct file* filp, char* buf, size_t length, loff_t* offset);
-ssize_t device_write_impl(struct file* filp, const char* buf, size_t length, loff_t* offset);
-
-long ioctl_do_module_reset(void);
-long ioctl_is_module_reset(bool* is_module_reset);
-long ioctl_enable_user_input_trimming(const bool* should_trim);
-long ioctl_is_user_input_trimming_enabled(bool* is_trimming_enabled);
-long ioctl_get_buffer_size(size_t* buffer_size);
-long ioctl_set_output_prefix(const void* output_prefix_data);
-long ioctl_get_output_prefix_size(size_t* output_prefix_size);
-long ioctl_enable_input_append_mode(const bool* should_append);
-long ioctl_is_input_append_mode_enabled(bool* is_append_enabled);
+/* The data buffer can be mapped read-only into user space (mmap), the mapping consists of:
+   - page 0: header containing the data buffer offsets (see below)
+   - page 1 onwards: data buffer chunks, in order (only the chunks containing chars below tail are guaranteed to exist,
+     accessing any other chunk might result in a SIGBUS)
+   Mapping fails with -EBUSY while compression is enabled (see below).
+*/
+struct data_buffer_header
+{
+    size_t head; // index of the first char to be read from data buffer by the next read operation
+    size_t tail; // data buffer length
+};
+
+#define TRIM_USER_INPUT_ENABLED 0b00000001
+#define USER_INPUT_APPENDING_ENABLED 0b00000010
+#define WAIT_FOR_DATA_ENABLED 0b00000100 // read waits at the end of the output until it grows (EAGAIN if O_NONBLOCK)
+#define STREAMING_MODE_ENABLED 0b00001000 // write enqueues to/read dequeues from a byte ring instead of the data buffer
+#define RECORD_MODE_ENABLED 0b00010000    // each write is queued as a discrete record, each read dequeues one record
+#define SUPPORTED_SETTINGS                                                                                             \
+    (TRIM_USER_INPUT_ENABLED | USER_INPUT_APPENDING_ENABLED | WAIT_FOR_DATA_ENABLED | STREAMING_MODE_ENABLED |         \
+     RECORD_MODE_ENABLED)
+#define QUEUE_MODES (STREAMING_MODE_ENABLED | RECORD_MODE_ENABLED) // mutually exclusive, bypass the data buffer
+#define DEFAULT_SETTINGS 0b00000001
+
+// should be increased each time the layout of the config/state structures changes
+#define IOCTL_STRING_OPS_CONFIG_VERSION 1
+
+// applied as a whole by the "set config" ioctl (nothing gets changed if any of the items is invalid)
+struct ioctl_string_ops_config
+{
+    uint32_t version;          // should be IOCTL_STRING_OPS_CONFIG_VERSION
+    uint32_t settings;         // combination of the settings flags defined above
+    size_t max_output_size;    // same meaning as for the "set max output size" ioctl
+    size_t output_prefix_size; // 0: no output prefix
+    const char* output_prefix; // prefix chars, no terminating '\0' required
+};
+
+// record lengths are stored on 2 bytes (within the record queue and by the "dequeue records" ioctl)
+#define MAX_RECORD_SIZE 65535
+
+/* Used by the "dequeue records" ioctl: up to max_records_count whole records are copied to the user buffer, each one
+   preceded by its length (uint16_t). The ioctl doesn't wait for records, it dequeues only the ones that fit into the
+   buffer.
+*/
+struct ioctl_string_ops_records
+{
+    void* buffer;             // user buffer receiving the records
+    size_t buffer_size;       // size of the user buffer
+    size_t max_records_count; // maximum number of records to dequeue (input)
+    size_t records_count;     // number of dequeued records (output)
+    size_t bytes_count;       // number of bytes copied to the user buffer, record lengths included (output)
+};
+
+#define READ_FILTER_NONE 0      // all lines are read (filter removed)
+#define READ_FILTER_SUBSTRING 1 // lines containing the pattern (binary-safe)
+#define READ_FILTER_GLOB 2      // lines matching the pattern as a whole ('*', '?' and [] classes, see glob_match())
+#define MAX_READ_FILTER_PATTERN_SIZE 255
+
+/* Used by the "set read filter" ioctl. The filter belongs to the file it is set through: when reading from the file
+   position, only the data buffer lines (terminated by '\n' or by the end of the content) matching the filter are copied
+   to user, the other ones are skipped. The file position still refers to the whole output, i.e. it advances past the
+   skipped lines as well. Only whole lines are copied, except for a matching line not fitting into the user buffer at
+   all (its remainder is provided by the next reads). Lines longer than a page are matched by their first page, glob
+   matching stops at the first '\0' char of the line. The output prefix and the maximum output size windows (shared
+   reading cursor) are not filtered.
+*/
+struct ioctl_string_ops_read_filter
+{
+    uint32_t type;       // one of the filter types defined above
+    size_t pattern_size; // maximum MAX_READ_FILTER_PATTERN_SIZE chars (ignored if no filter)
+    const char* pattern; // no terminating '\0' required, no '\0' chars allowed for glob patterns
+};
+
+#define COMPRESSION_MODE_NONE 0
+#define COMPRESSION_MODE_LZ4 1
+#define MAX_COMPRESSION_CHUNK_PAGES 16
+
+/* Used by the "set compression" ioctl. In LZ4 mode the data buffer is split into chunks of chunk_size bytes, each chunk
+   located entirely below the data buffer tail (no longer modified when appending) is stored compressed and gets
+   decompressed when read. Changing the chunk size or disabling compression decompresses the stored content first.
+   Enabling compression fails with -EBUSY while the data buffer is mapped (all mappings should be removed first).
+*/
+struct ioctl_string_ops_compression
+{
+    uint32_t mode;     // one of the compression modes defined above
+    size_t chunk_size; // multiple of the page size, at most MAX_COMPRESSION_CHUNK_PAGES pages (ignored if disabled)
+};
+
+// provided by the "get compression stats" ioctl
+struct ioctl_string_ops_compression_stats
+{
+    uint32_t mode;
+    size_t chunk_size;
+    size_t compressed_chars_count; // data buffer chars stored compressed
+    size_t compressed_size;        // memory taken by the compressed chars
+    uint32_t ratio_percent;        // compressed chars count / compressed size (e.g. 400: 4 times less memory)
+};
+
+// provided by the "get state" ioctl
+struct ioctl_string_ops_state
+{
+    uint32_t version;
+    uint32_t settings;
+    size_t buffer_size;
+    size_t output_prefix_size;
+    size_t max_output_size;
+    size_t chars_left_to_read_count;
+};
+
+// each minor number is an independent channel (see create_channels()), opaque outside the implementation
+struct ioctl_string_ops_channel;
+
+/* Each open file gets its own reading state (private data) referring to the channel of its minor number, any number
+   of files can be open concurrently. Opening fails with -ENODEV if the minor number has no channel.
+*/
+int device_open_impl(struct inode* inode, struct file* filp);
+void device_release_impl(struct inode* inode, struct file* filp);
+struct ioctl_string_ops_channel* get_file_channel(const struct file* filp);
+
+ssize_t device_read_iter_impl(struct kiocb* iocb, struct iov_iter* to);
+ssize_t device_write_iter_impl(struct kiocb* iocb, struct iov_iter* from);
+int device_mmap_impl(struct file* filp, struct vm_area_struct* vma);
+loff_t device_llseek_impl(struct file* filp, loff_t offset, int whence);
+__poll_t device_poll_impl(struct file* filp, struct poll_table_struct* wait);
+
+// the "module reset" commands apply to the channel of the file only
+long ioctl_do_module_reset(struct ioctl_string_ops_channel* channel);
+long ioctl_is_module_reset(struct ioctl_string_ops_channel* channel, bool* is_module_reset);
+long ioctl_enable_user_input_trimming(struct ioctl_string_ops_channel* channel, const bool* should_trim);
+long ioctl_is_user_input_trimming_enabled(struct ioctl_string_ops_channel* channel, bool* is_trimming_enabled);
+long ioctl_get_buffer_size(struct ioctl_string_ops_channel* channel, size_t* buffer_size);
+long ioctl_set_output_prefix(struct ioctl_string_ops_channel* channel, const void* output_prefix_data);
+long ioctl_get_output_prefix_size(struct ioctl_string_ops_channel* channel, size_t* output_prefix_size);
+long ioctl_enable_input_append_mode(struct ioctl_string_ops_channel* channel, const bool* should_append);
+long ioctl_is_input_append_mode_enabled(struct ioctl_string_ops_channel* channel, bool* is_append_enabled);
+long ioctl_enable_wait_for_data(struct ioctl_string_ops_channel* channel, const bool* should_wait);
+long ioctl_is_wait_for_data_enabled(struct ioctl_string_ops_channel* channel, bool* is_wait_enabled);
+long ioctl_enable_streaming_mode(struct ioctl_string_ops_channel* channel, const bool* should_stream);
+long ioctl_is_streaming_mode_enabled(struct ioctl_string_ops_channel* channel, bool* is_streaming_enabled);
+long ioctl_enable_record_mode(struct ioctl_string_ops_channel* channel, const bool* should_queue_records);
+long ioctl_is_record_mode_enabled(struct ioctl_string_ops_channel* channel, bool* is_records_enabled);
+long ioctl_dequeue_records(struct ioctl_string_ops_channel* channel, struct ioctl_string_ops_records* records);
+long ioctl_set_compression(struct ioctl_string_ops_channel* channel,
+                           const struct ioctl_string_ops_compression* compression);
+long ioctl_get_compression_stats(struct ioctl_string_ops_channel* channel,
+                                 struct ioctl_string_ops_compression_stats* compression_stats);
+
+// per file setting, should be executed without the channel data locked (serialized with the reads of the file only)
+long ioctl_set_read_filter(struct file* filp, const struct ioctl_string_ops_read_filter* read_filter);
 
 /* The value input by user is the maximum number of bytes to read from data buffer
    The value written back by module is the number of characters left to read from data buffer
    (output prefix excluded)
 */
-long ioctl_set_max_output_size(size_t* value);
+long ioctl_set_max_output_size(struct ioctl_string_ops_channel* channel, size_t* value);
+
+long ioctl_get_max_output_size(struct ioctl_string_ops_channel* channel, size_t* max_output_length);
+
+long ioctl_set_config(struct ioctl_string_ops_channel* channel, const struct ioctl_string_ops_config* config);
+long ioctl_get_state(struct ioctl_string_ops_channel* channel, struct ioctl_string_ops_state* state);
+
+// the buffers are allocated on first use (see parameters), sizes are validated by caller
+void set_buffer_sizes(size_t max_buffer_size, size_t max_output_prefix_size, size_t stream_buffer_size,
+                      size_t max_record_queue_size);
 
-long ioctl_get_max_output_size(size_t* max_output_length);
+// the channels are created in their initial (idle) state, nothing else gets allocated until used
+int create_channels(size_t count);
+void free_module_data(void);
+void reset_module_data(void); // all channels
 
-void reset_module_data(void);
+// the ioctl commands should be executed with the channel data locked (returns -ERESTARTSYS if interrupted)
+int lock_channel_data(struct ioctl_string_ops_channel* channel);
+void unlock_channel_data(struct ioctl_string_ops_channel* channel);
@@ -0,0 +1,21 @@
+#pragma once
+
+// operation counters, accounted per CPU and aggregated when the debugfs stats file is read
+enum ioctl_string_ops_counter
+{
+    COUNTER_READS,
+    COUNTER_WRITES,
+    COUNTER_BYTES_OUT,        // chars sent to user (output prefix included)
+    COUNTER_BYTES_IN,         // chars consumed from user input
+    COUNTER_TRUNCATED_WRITES, // user input not entirely stored due to lack of space within the data buffer
+    COUNTER_PREFIXED_READS,   // reads that prepended the output prefix to the data buffer content
+    COUNTERS_COUNT
+};
+
+void increment_counter(enum ioctl_string_ops_counter counter);
+void add_to_counter(enum ioctl_string_ops_counter counter, size_t value);
+void count_ioctl_command(unsigned int command);
+
+// the debugfs files are optional, the module works the same if they cannot be created
+void create_stats_files(void);
+void remove_stats_files(void);
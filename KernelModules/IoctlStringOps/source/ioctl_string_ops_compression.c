@@ -0,0 +1,121 @@
+#include <linux/lz4.h>
+#include <linux/mm.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+
+#include "ioctl_string_ops_compression.h"
+
+int allocate_compression_buffers(struct compression_buffers* buffers, size_t chunks_count)
+{
+    int result = 0;
+
+    buffers->uncompressed_size = chunks_count * PAGE_SIZE;
+    buffers->compression_bound = LZ4_compressBound(buffers->uncompressed_size);
+    buffers->uncompressed_buffer = vmalloc(buffers->uncompressed_size);
+    buffers->output_buffer = vmalloc(buffers->compression_bound);
+    buffers->work_memory = vmalloc(LZ4_MEM_COMPRESS);
+    buffers->cached_chunks = NULL;
+
+    if (!buffers->uncompressed_buffer || !buffers->output_buffer || !buffers->work_memory)
+    {
+        free_compression_buffers(buffers);
+        result = -ENOMEM;
+    }
+
+    return result;
+}
+
+void free_compression_buffers(struct compression_buffers* buffers)
+{
+    vfree(buffers->uncompressed_buffer);
+    vfree(buffers->output_buffer);
+    vfree(buffers->work_memory);
+
+    buffers->uncompressed_buffer = NULL;
+    buffers->output_buffer = NULL;
+    buffers->work_memory = NULL;
+    buffers->uncompressed_size = 0;
+    buffers->compression_bound = 0;
+    buffers->cached_chunks = NULL;
+}
+
+int compress_chunks(struct compression_buffers* buffers, char* const* chunks, size_t chunks_count,
+                    struct compressed_chunks** compressed)
+{
+    int result = -E2BIG;
+
+    do
+    {
+        if (chunks_count * PAGE_SIZE != buffers->uncompressed_size)
+        {
+            result = -EINVAL;
+            break;
+        }
+
+        for (size_t chunk_index = 0; chunk_index < chunks_count; ++chunk_index)
+        {
+            memcpy(buffers->uncompressed_buffer + chunk_index * PAGE_SIZE, chunks[chunk_index], PAGE_SIZE);
+        }
+
+        reset_decompression_cache(buffers); // the cached content got overwritten
+
+        const int compressed_size = LZ4_compress_default(
+            buffers->uncompressed_buffer, buffers->output_buffer, (int)buffers->uncompressed_size,
+            (int)buffers->compression_bound, buffers->work_memory);
+
+        // 0: compression failed
+        if (compressed_size <= 0 || (size_t)compressed_size >= buffers->uncompressed_size)
+        {
+            break;
+        }
+
+        struct compressed_chunks* const group = kmalloc(struct_size(group, data, compressed_size), GFP_KERNEL);
+
+        if (!group)
+        {
+            result = -ENOMEM;
+            break;
+        }
+
+        group->size = (size_t)compressed_size;
+        memcpy(group->data, buffers->output_buffer, group->size);
+        *compressed = group;
+        result = 0;
+    } while (false);
+
+    return result;
+}
+
+const char* decompress_chunks(struct compression_buffers* buffers, const struct compressed_chunks* compressed)
+{
+    if (compressed != buffers->cached_chunks)
+    {
+        const int decompressed_size = LZ4_decompress_safe(compressed->data, buffers->uncompressed_buffer,
+                                                          (int)compressed->size, (int)buffers->uncompressed_size);
+
+        buffers->cached_chunks = decompressed_size == (int)buffers->uncompressed_size ? compressed : NULL;
+
+        if (!buffers->cached_chunks)
+        {
+            pr_err("%s: failed decompressing the data buffer chunks!\n", THIS_MODULE->name);
+        }
+    }
+
+    return buffers->cached_chunks ? buffers->uncompressed_buffer : NULL;
+}
+
+bool decompress_chunks_to(const struct compressed_chunks* compressed, char* destination, size_t size)
+{
+    return LZ4_decompress_safe(compressed->data, destination, (int)compressed->size, (int)size) == (int)size;
+}
+
+void reset_decompression_cache(struct compression_buffers* buffers)
+{
+    buffers->cached_chunks = NULL;
+}
+
+void release_compressed_chunks(struct compressed_chunks* compressed)
+{
+    kfree(compressed);
+}
@@ -1,271 +1,2827 @@
+#include <linux/ctype.h>
+#include <linux/fs.h>
+#include <linux/glob.h>
+#include <linux/kfifo.h>
+#include <linux/list.h>
+#include <linux/mm.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+#include <linux/scatterlist.h>
+#include <linux/seqlock.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/srcu.h>
+#include <linux/string.h>
 #include <linux/uaccess.h>
+#include <linux/uio.h>
+#include <linux/wait.h>
 
+#include "ioctl_string_ops_compression.h"
 #include "ioctl_string_ops_impl.h"
+#include "ioctl_string_ops_stats.h"
+#include "kernel_utilities_log.h"
 
-#define BUFFER_SIZE 1024
-#define PREFIX_BUFFER_SIZE 128
+#define BUFFER_CHUNK_SIZE PAGE_SIZE
 
-#define TRIM_USER_INPUT_ENABLED 0b00000001
-#define USER_INPUT_APPENDING_ENABLED 0b00000010
-#define DEFAULT_SETTINGS 0b00000001
+// page offsets within the user space mapping of the data buffer (the data chunks follow the header, in order)
+#define HEADER_PAGE_OFFSET 0
+#define FIRST_CHUNK_PAGE_OFFSET 1
 
-static char input_buffer[BUFFER_SIZE]; // buffer where trimmed/untrimmed input is stored before writing to data buffer
-static char buffer[BUFFER_SIZE];       // data buffer
-static char
-    output_prefix[PREFIX_BUFFER_SIZE]; // prefix to be prepended to data read from data buffer before sending to user
+// the stream fifo content might wrap around the end of the ring, i.e. maximum two contiguous segments per transfer
+#define STREAM_SEGMENTS_COUNT 2
 
-static size_t max_output_size = 0;
-static size_t chars_left_to_read_count = 0;
+// longer lines are matched by their beginning (see struct ioctl_string_ops_read_filter)
+#define MAX_READ_FILTER_LINE_SIZE PAGE_SIZE
 
-/* 0: trim user input
-   1: enable appending user input
-   2-7: reserved for future use
+// lockless reads falling back to the data mutex when no consistent snapshot could be taken (writer active meanwhile)
+#define MAX_SNAPSHOT_READ_ATTEMPTS 3
+
+/* Data buffer content of a channel: chunks table and compressed groups (see below). Replaced as a whole on reset and
+   when overwritten. On reset it gets released once the lockless readers left their SRCU read side sections (no grace
+   period waited for by the data mutex holders), when overwritten it is kept as spare content for the next overwrite.
+*/
+struct buffer_content
+{
+    struct rcu_head rcu;
+    struct compressed_chunks** compressed_groups; // one entry per group (NULL: not compressed), allocated on demand
+    char* chunks[];                               // buffer_chunks_count entries (NULL: not allocated or compressed)
+};
+
+// output prefix chars, released the same way as the content once replaced (see replace_output_prefix())
+struct output_prefix
+{
+    struct rcu_head rcu;
+    char chars[]; // binary-safe, no terminating '\0'
+};
+
+/* Each minor number is a fully independent channel: data buffer, output prefix, settings, queues and mutexes are per
+   channel, so unrelated producers (consumers) neither contend for nor clobber each other's content. The channels are
+   created on module load, their buffers are allocated on demand (same as for a single channel) and sized by the module
+   parameters (shared by all channels).
+*/
+struct ioctl_string_ops_channel
+{
+    /* The data buffer consists of page sized chunks that get allocated on demand (when the content grows) and are kept
+       until the content gets replaced (overwritten or reset). The chunks table (see struct buffer_content) is allocated
+       on first write, sized for the maximum buffer capacity so the existing content never gets reallocated or copied
+       when appending. Nothing is allocated until the channel is used, the memory allocated meanwhile (content, output
+       prefix, stream fifo, record queue) is released on reset.
+    */
+    struct buffer_content* buffer_content; // NULL until first written
+    size_t buffer_length;                  // number of chars currently stored in the data buffer
+
+    /* Overwrite mode: the user input is written to the spare content (not published, allocated on first overwrite),
+       which then gets swapped with the published one. The lockless readers still accessing the unpublished content
+       discard their snapshot (content replaced), so it can be reused right away. Its chunks are kept until reset.
+    */
+    struct buffer_content* spare_content;
+
+    // publishing/releasing the chunks table and chunks is serialized with the mapping fault handler (no data mutex)
+    spinlock_t chunks_lock;
+
+    /* Optional compression (see struct ioctl_string_ops_compression): the chunks are grouped by
+       compression_chunks_count, each group located entirely below the data buffer length gets sealed (appending doesn't
+       modify it anymore). A sealed group is stored compressed (see struct buffer_content) and its chunks released,
+       unless compressing doesn't save memory (chunks kept as they are). Compression and mmap are mutually exclusive
+       (checked under the mappings mutex), so the sealed chunks are never mapped.
+    */
+    size_t compression_chunks_count; // chunks per group, 0 if compression is disabled
+    size_t sealed_groups_count;      // groups sealed since the content got last replaced
+    struct compression_buffers compression_buffers;
+
+    // prefix to be prepended to data read from data buffer before sending to user (binary-safe, no terminating '\0')
+    struct output_prefix* output_prefix; // allocated with the exact prefix size, NULL if empty
+    size_t output_prefix_length;
+
+    /* Offsets of the data buffer published to user space (first page of the mapping). Allocated on first mmap() and
+       kept until the module exits (existing mappings keep referring to it after reset).
+    */
+    struct data_buffer_header* buffer_header;
+
+    /* Address spaces the data buffer is mapped through (see struct data_buffer_mapping), the chunks get unmapped from
+       all of them before being released. Protected by the mappings mutex, which is acquired after the data mutex or
+       from the memory mapping callbacks (mmap lock held) and never held while acquiring any of them.
+    */
+    struct list_head mappings;
+    struct mutex mappings_mutex;
+
+    size_t max_output_size;
+    size_t chars_left_to_read_count;
+
+    /* 0: trim user input
+       1: enable appending user input
+       2: enable waiting for data (read)
+       3: enable streaming mode
+       4: enable record mode
+       5-7: reserved for future use
+    */
+    uint8_t settings;
+
+    // incremented each time the data buffer content gets replaced instead of being appended (see struct reader_data)
+    u64 content_generation;
+
+    // readers waiting for new data (if enabled, see settings) sleep here until the output grows beyond their position
+    wait_queue_head_t data_wait_queue;
+
+    /* Byte ring used instead of the data buffer in streaming mode: writers enqueue, readers dequeue. One reader and one
+       writer can access it concurrently without locking (the kfifo indexes are only updated by their owner), the
+       readers (writers) are serialized among themselves by the stream read (write) mutex. Trimming, appending, output
+       prefix and maximum output size do not apply to this mode. Allocated when the streaming mode gets enabled (first
+       time or after reset).
+    */
+    struct kfifo stream_fifo;
+
+    /* Bounded queue used instead of the data buffer in record mode: each write is enqueued as a discrete record (the
+       length is stored in front of it), each read dequeues a whole record. Shares the stream read/write mutexes with
+       the stream fifo (the two modes are mutually exclusive). Trimming, appending, output prefix and maximum output
+       size do not apply to this mode. Allocated when the record mode gets enabled (first time or after reset).
+    */
+    struct kfifo_rec_ptr_2 record_queue;
+
+    // writers waiting for free space within the stream fifo/record queue sleep here until a reader dequeues
+    wait_queue_head_t space_wait_queue;
+
+    /* Any number of files can be opened concurrently:
+       - data mutex: data buffer, output prefix, settings and shared reading cursor (max output size)
+       - stream read/write mutexes: stream fifo/record queue readers, respectively writers (acquired after the data
+         mutex, if both)
+       Waiting for data/space happens without holding any mutex.
+    */
+    struct mutex data_mutex;
+    struct mutex stream_read_mutex;
+    struct mutex stream_write_mutex;
+
+    /* Reading from the file position doesn't take the data mutex: the output is copied as a snapshot validated by the
+       content sequence count, which the writers (data mutex holders) increment around publishing any change of the
+       data buffer content/length, output prefix or chunks. The write sections only publish pointers and lengths (no
+       sleeping, no user memory access): the user input is copied beforehand where the readers don't look (beyond the
+       data buffer length or into a content that is not published yet). A snapshot taken while a writer is active is
+       discarded without waiting and retried a few times, then the reader falls back to the data mutex. The content
+       (chunks table, chunks, compressed groups) and output prefix are released only after the lockless readers left
+       their SRCU read side section (memory still valid for the snapshot being discarded).
+    */
+    seqcount_mutex_t content_seqcount; // associated with the data mutex (write sections checked by lockdep)
+    struct srcu_struct readers_srcu;
+};
+
+static struct ioctl_string_ops_channel* channels = NULL; // one per minor number
+static size_t channels_count = 0;
+
+// sizes shared by all channels (module parameters)
+static size_t buffer_chunks_count = 0; // number of entries in the chunks table
+static size_t buffer_capacity = 0;     // maximum number of chars that can be stored in the data buffer
+static size_t max_prefix_size = 0;
+static size_t stream_fifo_size = 0;
+static size_t record_queue_size = 0;
+
+// read filter of a file (see struct ioctl_string_ops_read_filter)
+struct read_filter
+{
+    uint32_t type;
+    char* pattern; // '\0' terminated (glob_match() requirement)
+    size_t pattern_length;
+    char* line; // the line to be matched gets gathered here ('\0' terminated), the chunks are not contiguous
+};
+
+/* Compressed group decompressed by a lockless reader (see peek_data_buffer_address()), kept for the next reads of the
+   file. The sealed groups never change within a content generation, so the group is identified by its generation and
+   position.
+*/
+struct decompressed_group
+{
+    char* content; // MAX_COMPRESSION_CHUNK_PAGES pages, allocated once compression got enabled (NULL if not available)
+    u64 content_generation;
+    size_t group_index;
+    size_t chunks_count; // chunks per group, 0 if nothing decompressed
+};
+
+/* Per file state (private data). Each file reads the output of its channel from its own position, multiple readers
+   (subscribers) can follow the same data buffer content independently. If waiting for data is enabled and the content
+   got replaced since the last read of the file, the next read restarts from the beginning of the output.
+*/
+struct reader_data
+{
+    struct ioctl_string_ops_channel* channel; // channel of the opened minor number
+    u64 content_generation;                   // generation of the content the file position refers to
+    struct read_filter* filter;               // NULL if all lines are read
+    loff_t matched_line_position;             // position within a partially read matching line (-1 if none)
+    struct decompressed_group decompressed_group; // lockless reads of the compressed groups
+    struct mutex read_mutex; // serializes the reads of the file with its filter changes (acquired before data mutex)
+};
+
+/* Output (prefix and data buffer content) as seen by a reader: either read under the data mutex or taken as a lockless
+   snapshot (see struct ioctl_string_ops_channel), in which case it is only used if validated by the sequence count.
+*/
+struct output_view
+{
+    const char* prefix;
+    size_t prefix_length;
+    size_t buffer_length;
+    u64 content_generation;
+    bool is_lockless;                              // the chunks are accessed without allocating (see below)
+    unsigned int sequence;                         // lockless: content sequence the view got taken at
+    struct decompressed_group* decompressed_group; // lockless: compressed groups decompressed here (NULL: not read)
+};
+
+/***** HELPER FUNCTIONS *****/
+
+// should be called each time the data buffer content or the chars left to read count change (no-op if never mapped)
+static void publish_buffer_offsets(struct ioctl_string_ops_channel* channel)
+{
+    struct data_buffer_header* header = READ_ONCE(channel->buffer_header);
+    const size_t head = channel->chars_left_to_read_count < channel->buffer_length
+                            ? channel->buffer_length - channel->chars_left_to_read_count
+                            : 0;
+
+    if (header)
+    {
+        WRITE_ONCE(header->head, head);
+        WRITE_ONCE(header->tail, channel->buffer_length);
+    }
+}
+
+static bool is_streaming_mode_enabled(struct ioctl_string_ops_channel* channel)
+{
+    return READ_ONCE(channel->settings) & STREAMING_MODE_ENABLED;
+}
+
+static bool is_record_mode_enabled(struct ioctl_string_ops_channel* channel)
+{
+    return READ_ONCE(channel->settings) & RECORD_MODE_ENABLED;
+}
+
+/* Should be rechecked with the stream read/write mutex held before accessing the stream fifo (record queue): the mode
+   might have been disabled and the queues released meanwhile (channel reset by another file), a released kfifo still
+   reporting free space.
+*/
+static bool is_stream_fifo_usable(struct ioctl_string_ops_channel* channel)
+{
+    return is_streaming_mode_enabled(channel) && kfifo_initialized(&channel->stream_fifo);
+}
+
+static bool is_record_queue_usable(struct ioctl_string_ops_channel* channel)
+{
+    return is_record_mode_enabled(channel) && kfifo_initialized(&channel->record_queue);
+}
+
+// streaming or record mode: reading/writing dequeues/enqueues, the data buffer is not accessed
+static bool is_queue_mode_enabled(struct ioctl_string_ops_channel* channel)
+{
+    return READ_ONCE(channel->settings) & QUEUE_MODES;
+}
+
+// the output consists of the prefix followed by the data buffer content (file positions cover both of them)
+static size_t get_output_length(struct ioctl_string_ops_channel* channel)
+{
+    return READ_ONCE(channel->output_prefix_length) + READ_ONCE(channel->buffer_length);
+}
+
+static bool is_content_replaced(struct ioctl_string_ops_channel* channel, const struct file* filp)
+{
+    const struct reader_data* reader = filp->private_data;
+
+    return READ_ONCE(reader->content_generation) != READ_ONCE(channel->content_generation);
+}
+
+/* Streaming/record mode: the stream fifo/record queue should contain data.
+   Otherwise reading is always possible if waiting for data is disabled or a maximum output size is set (the reading
+   cursor is shared in this case, the position is ignored). If waiting for data is enabled, there should be output left
+   to read from the given position (from the beginning if the content got replaced meanwhile).
+*/
+static bool is_data_available_for_reading(struct ioctl_string_ops_channel* channel, const struct file* filp,
+                                          loff_t position)
+{
+    bool is_available = true;
+
+    if (is_streaming_mode_enabled(channel))
+    {
+        is_available = !kfifo_is_empty(&channel->stream_fifo);
+    }
+    else if (is_record_mode_enabled(channel))
+    {
+        is_available = !kfifo_is_empty(&channel->record_queue);
+    }
+    else if ((READ_ONCE(channel->settings) & WAIT_FOR_DATA_ENABLED) && READ_ONCE(channel->max_output_size) == 0)
+    {
+        is_available = (is_content_replaced(channel, filp) ? 0 : position) < get_output_length(channel);
+    }
+
+    return is_available;
+}
+
+/* Writing to the data buffer is always possible (the user input gets truncated if it doesn't fit into it). The stream
+   fifo should not be full, the record queue should have room for a whole record of the given size.
+*/
+static bool is_space_available_for_writing(struct ioctl_string_ops_channel* channel, size_t chars_count)
+{
+    bool is_available = true;
+
+    if (is_streaming_mode_enabled(channel))
+    {
+        is_available = !kfifo_is_full(&channel->stream_fifo);
+    }
+    else if (is_record_mode_enabled(channel))
+    {
+        is_available = kfifo_avail(&channel->record_queue) >= chars_count;
+    }
+
+    return is_available;
+}
+
+// should be called each time the output (stream fifo, record queue) content or the "wait for data" setting change
+static void notify_readers(struct ioctl_string_ops_channel* channel)
+{
+    wake_up_interruptible(&channel->data_wait_queue);
+}
+
+// should be called each time chars get dequeued from the stream fifo/record queue or the settings change
+static void notify_writers(struct ioctl_string_ops_channel* channel)
+{
+    wake_up_interruptible(&channel->space_wait_queue);
+}
+
+static bool is_blocking_io(const struct kiocb* iocb)
+{
+    return !(iocb->ki_filp->f_flags & O_NONBLOCK) && !(iocb->ki_flags & IOCB_NOWAIT);
+}
+
+// returns 0 if data is available for reading, -EAGAIN for non-blocking I/O or -ERESTARTSYS if interrupted
+static int wait_for_data(struct ioctl_string_ops_channel* channel, const struct kiocb* iocb)
+{
+    int result = 0;
+
+    if (!is_data_available_for_reading(channel, iocb->ki_filp, iocb->ki_pos))
+    {
+        result = is_blocking_io(iocb)
+                     ? wait_event_interruptible(channel->data_wait_queue,
+                                                is_data_available_for_reading(channel, iocb->ki_filp, iocb->ki_pos))
+                     : -EAGAIN;
+    }
+
+    return result;
+}
+
+// returns 0 if chars can be written, -EAGAIN for non-blocking I/O or -ERESTARTSYS if interrupted
+static int wait_for_space(struct ioctl_string_ops_channel* channel, const struct kiocb* iocb, size_t chars_count)
+{
+    int result = 0;
+
+    if (!is_space_available_for_writing(channel, chars_count))
+    {
+        result = is_blocking_io(iocb)
+                     ? wait_event_interruptible(channel->space_wait_queue,
+                                                is_space_available_for_writing(channel, chars_count))
+                     : -EAGAIN;
+    }
+
+    return result;
+}
+
+/* The stream fifo (record queue) is emptied each time the streaming (record) mode gets enabled, waiting
+   readers/writers recheck their condition. Should be called with the data mutex held.
+*/
+static void update_settings(struct ioctl_string_ops_channel* channel, uint8_t new_settings)
+{
+    const bool should_reset_stream = (new_settings & STREAMING_MODE_ENABLED) && !is_streaming_mode_enabled(channel);
+    const bool should_reset_records = (new_settings & RECORD_MODE_ENABLED) && !is_record_mode_enabled(channel);
+
+    if (should_reset_stream || should_reset_records)
+    {
+        mutex_lock(&channel->stream_read_mutex);
+        mutex_lock(&channel->stream_write_mutex);
+
+        if (should_reset_stream)
+        {
+            kfifo_reset(&channel->stream_fifo);
+        }
+
+        if (should_reset_records)
+        {
+            kfifo_reset(&channel->record_queue);
+        }
+
+        mutex_unlock(&channel->stream_write_mutex);
+        mutex_unlock(&channel->stream_read_mutex);
+    }
+
+    WRITE_ONCE(channel->settings, new_settings);
+
+    notify_readers(channel);
+    notify_writers(channel);
+}
+
+static void reset_max_output_size(struct ioctl_string_ops_channel* channel)
+{
+    channel->max_output_size = 0;
+    channel->chars_left_to_read_count = channel->buffer_length;
+    publish_buffer_offsets(channel);
+}
+
+static size_t compute_data_buffer_current_read_index(struct ioctl_string_ops_channel* channel)
+{
+    size_t index = 0;
+
+    if (channel->max_output_size > 0)
+    {
+        if (channel->chars_left_to_read_count == 0 || channel->chars_left_to_read_count > channel->buffer_length)
+        {
+            reset_max_output_size(channel);
+            pr_err("%s: invalid chars left to read count, should have been positive and not exceed buffer length",
+                   THIS_MODULE->name);
+        }
+
+        index = channel->buffer_length - channel->chars_left_to_read_count;
+    }
+
+    return index;
+}
+
+/* Caps the requested maximum output size to the count of chars that are left to read (0: read whole content and move
+   reading to the beginning of the buffer). The module state is not modified, the caller decides whether to apply the
+   computed values.
+*/
+static void compute_max_output_size(struct ioctl_string_ops_channel* channel, size_t* max_chars_to_read_count,
+                                    size_t* remaining_chars_count)
+{
+    *remaining_chars_count = channel->chars_left_to_read_count;
+
+    if (*max_chars_to_read_count == 0)
+    {
+        *remaining_chars_count = channel->buffer_length; // move reading to the beginning of the buffer
+    }
+    else if (*max_chars_to_read_count > *remaining_chars_count)
+    {
+        *max_chars_to_read_count = *remaining_chars_count;
+    }
+}
+
+// the prefix may contain any chars (binary-safe), it is copied to a newly allocated buffer (none if empty prefix)
+static bool copy_output_prefix_from_user(struct output_prefix** dest, const char* src, size_t prefix_size)
+{
+    bool success = false;
+
+    *dest = NULL;
+
+    if (prefix_size == 0)
+    {
+        success = true;
+    }
+    else if (src && prefix_size <= max_prefix_size)
+    {
+        struct output_prefix* const prefix = kmalloc(struct_size(prefix, chars, prefix_size), GFP_KERNEL);
+
+        if (prefix && copy_from_user(prefix->chars, src, prefix_size) == 0)
+        {
+            *dest = prefix;
+            success = true;
+        }
+        else
+        {
+            kfree(prefix);
+        }
+    }
+
+    return success;
+}
+
+// SRCU callback: the prefix is no longer accessed by any reader
+static void free_output_prefix(struct rcu_head* rcu)
+{
+    kfree(container_of(rcu, struct output_prefix, rcu));
+}
+
+/* Takes ownership of the new prefix (see copy_output_prefix_from_user()). The old prefix gets released once the
+   lockless readers left their SRCU read side sections (no grace period waited for by the data mutex holders).
+*/
+static void replace_output_prefix(struct ioctl_string_ops_channel* channel, struct output_prefix* new_prefix,
+                                  size_t new_prefix_length)
+{
+    struct output_prefix* const old_prefix = channel->output_prefix;
+
+    write_seqcount_begin(&channel->content_seqcount);
+    WRITE_ONCE(channel->output_prefix, new_prefix);
+    WRITE_ONCE(channel->output_prefix_length, new_prefix_length);
+    write_seqcount_end(&channel->content_seqcount);
+
+    if (old_prefix)
+    {
+        call_srcu(&channel->readers_srcu, &old_prefix->rcu, free_output_prefix);
+    }
+}
+
+/* The stream fifo/record queue get allocated when the corresponding mode is about to be enabled (size rounded to 2^n).
+   On failure, the queues allocated by this call are released (the existing ones are kept).
+*/
+static int allocate_queues(struct ioctl_string_ops_channel* channel, uint8_t new_settings)
+{
+    int result = 0;
+    bool is_stream_fifo_allocated = false;
+
+    if ((new_settings & STREAMING_MODE_ENABLED) && !kfifo_initialized(&channel->stream_fifo))
+    {
+        result = kfifo_alloc(&channel->stream_fifo, stream_fifo_size, GFP_KERNEL);
+        is_stream_fifo_allocated = result == 0;
+    }
+
+    if (result == 0 && (new_settings & RECORD_MODE_ENABLED) && !kfifo_initialized(&channel->record_queue))
+    {
+        result = kfifo_alloc(&channel->record_queue, record_queue_size, GFP_KERNEL);
+    }
+
+    if (result < 0)
+    {
+        if (is_stream_fifo_allocated)
+        {
+            kfifo_free(&channel->stream_fifo);
+        }
+
+        pr_err("%s: cannot allocate memory for the stream fifo/record queue\n", THIS_MODULE->name);
+    }
+
+    return result;
+}
+
+// should be called with the data mutex held and both queue modes disabled
+static void free_queues(struct ioctl_string_ops_channel* channel)
+{
+    mutex_lock(&channel->stream_read_mutex);
+    mutex_lock(&channel->stream_write_mutex);
+    kfifo_free(&channel->stream_fifo); // no-op if not allocated
+    kfifo_free(&channel->record_queue);
+    mutex_unlock(&channel->stream_write_mutex);
+    mutex_unlock(&channel->stream_read_mutex);
+}
+
+/* Address space (device file inode) the data buffer of a channel is mapped through. Multiple device nodes of the same
+   minor number have distinct address spaces, each one is tracked while any of its mappings (VMAs) exists.
+*/
+struct data_buffer_mapping
+{
+    struct list_head node; // within the mappings list of the channel
+    struct ioctl_string_ops_channel* channel;
+    struct address_space* address_space;
+    size_t vmas_count;
+};
+
+// the pages still referenced by the user space mappings get freed once unmapped (from all address spaces)
+static void unmap_data_buffer_chunks(struct ioctl_string_ops_channel* channel, size_t first_chunk_index,
+                                     size_t chunks_count)
+{
+    struct data_buffer_mapping* mapping;
+
+    mutex_lock(&channel->mappings_mutex);
+
+    list_for_each_entry(mapping, &channel->mappings, node)
+    {
+        unmap_mapping_range(mapping->address_space, (loff_t)(FIRST_CHUNK_PAGE_OFFSET + first_chunk_index) << PAGE_SHIFT,
+                            (loff_t)chunks_count << PAGE_SHIFT, 1);
+    }
+
+    mutex_unlock(&channel->mappings_mutex);
+}
+
+// SRCU callback: the content is no longer reachable by any reader
+static void free_buffer_content(struct rcu_head* rcu)
+{
+    struct buffer_content* const content = container_of(rcu, struct buffer_content, rcu);
+
+    for (size_t chunk_index = 0; chunk_index < buffer_chunks_count; ++chunk_index)
+    {
+        if (content->chunks[chunk_index])
+        {
+            free_page((unsigned long)content->chunks[chunk_index]);
+        }
+    }
+
+    if (content->compressed_groups)
+    {
+        for (size_t group_index = 0; group_index < buffer_chunks_count; ++group_index)
+        {
+            release_compressed_chunks(content->compressed_groups[group_index]);
+        }
+
+        kvfree(content->compressed_groups);
+    }
+
+    kvfree(content);
+}
+
+static struct buffer_content* allocate_buffer_content(void)
+{
+    struct buffer_content* const content = kvzalloc(struct_size(content, chunks, buffer_chunks_count), GFP_KERNEL);
+
+    return content;
+}
+
+/* The new content (NULL: none) gets published along with its length, the old one being detached as a whole (the fault
+   handler can no longer map any of its chunks, the mapped ones get unmapped). Returns the old content, which remains
+   accessible to the lockless readers until they left their SRCU read side sections.
+*/
+static struct buffer_content* publish_data_buffer_content(struct ioctl_string_ops_channel* channel,
+                                                          struct buffer_content* new_content, size_t new_length)
+{
+    struct buffer_content* const old_content = channel->buffer_content;
+
+    write_seqcount_begin(&channel->content_seqcount);
+    spin_lock(&channel->chunks_lock);
+    WRITE_ONCE(channel->buffer_content, new_content);
+    spin_unlock(&channel->chunks_lock);
+    WRITE_ONCE(channel->buffer_length, new_length);
+    WRITE_ONCE(channel->content_generation, channel->content_generation + 1);
+    write_seqcount_end(&channel->content_seqcount);
+
+    channel->sealed_groups_count = 0;
+    reset_decompression_cache(&channel->compression_buffers);
+
+    if (old_content)
+    {
+        unmap_data_buffer_chunks(channel, 0, buffer_chunks_count);
+    }
+
+    return old_content;
+}
+
+// the content gets released once no longer accessed by the lockless readers (no-op if NULL)
+static void release_data_buffer_content(struct ioctl_string_ops_channel* channel, struct buffer_content* content)
+{
+    if (content)
+    {
+        call_srcu(&channel->readers_srcu, &content->rcu, free_buffer_content);
+    }
+}
+
+// both the published and the spare content get released (reset)
+static void free_data_buffer_contents(struct ioctl_string_ops_channel* channel)
+{
+    release_data_buffer_content(channel, publish_data_buffer_content(channel, NULL, 0));
+    release_data_buffer_content(channel, channel->spare_content);
+    channel->spare_content = NULL;
+}
+
+static struct compressed_chunks* get_compressed_group(struct ioctl_string_ops_channel* channel, size_t chunk_index)
+{
+    const struct buffer_content* const content = channel->buffer_content;
+
+    return content && content->compressed_groups && channel->compression_chunks_count > 0 &&
+                   chunk_index < buffer_chunks_count
+               ? content->compressed_groups[chunk_index / channel->compression_chunks_count]
+               : NULL;
+}
+
+/* Returns the address of the data buffer char located at the given index (NULL if its chunk is not allocated). The
+   chars of a compressed group are read from the decompressed copy, which should not be written to (sealed groups never
+   get modified anyway).
+*/
+static const char* get_data_buffer_address(struct ioctl_string_ops_channel* channel, size_t index)
+{
+    const char* address = NULL;
+    const size_t chunk_index = index / BUFFER_CHUNK_SIZE;
+    const struct compressed_chunks* const compressed_group = get_compressed_group(channel, chunk_index);
+
+    if (compressed_group)
+    {
+        const char* const group_content = decompress_chunks(&channel->compression_buffers, compressed_group);
+
+        const size_t group_chars_count = channel->compression_chunks_count * BUFFER_CHUNK_SIZE;
+
+        address = group_content ? group_content + index % group_chars_count : NULL;
+    }
+    else
+    {
+        const struct buffer_content* const content = channel->buffer_content;
+
+        if (content && chunk_index < buffer_chunks_count && content->chunks[chunk_index])
+        {
+            address = content->chunks[chunk_index] + index % BUFFER_CHUNK_SIZE;
+        }
+    }
+
+    return address;
+}
+
+/* Returns the address where the char located at the given index gets written to within the content, the chunk being
+   allocated if missing (NULL if out of memory). The content might be published already (append mode), so the new
+   chunks are published to the fault handler as well. The chunk should not belong to a compressed group.
+*/
+static char* get_write_destination(struct ioctl_string_ops_channel* channel, struct buffer_content* content,
+                                   size_t index)
+{
+    const size_t chunk_index = index / BUFFER_CHUNK_SIZE;
+
+    if (!content->chunks[chunk_index])
+    {
+        char* const chunk = (char*)get_zeroed_page(GFP_KERNEL);
+
+        spin_lock(&channel->chunks_lock);
+        WRITE_ONCE(content->chunks[chunk_index], chunk);
+        spin_unlock(&channel->chunks_lock);
+    }
+
+    return content->chunks[chunk_index] ? content->chunks[chunk_index] + index % BUFFER_CHUNK_SIZE : NULL;
+}
+
+/***** COMPRESSION FUNCTIONS *****/
+
+// chunks of a sealed group replaced by its compressed content, released after an SRCU grace period (see call_srcu())
+struct released_chunks
+{
+    struct rcu_head rcu;
+    size_t chunks_count;
+    char* chunks[MAX_COMPRESSION_CHUNK_PAGES];
+};
+
+// SRCU callback: the chunks are no longer accessed by any reader
+static void free_released_chunks(struct rcu_head* rcu)
+{
+    struct released_chunks* const released = container_of(rcu, struct released_chunks, rcu);
+
+    for (size_t index = 0; index < released->chunks_count; ++index)
+    {
+        free_page((unsigned long)released->chunks[index]);
+    }
+
+    kfree(released);
+}
+
+// SRCU callback: the group is no longer accessed by any reader
+static void free_compressed_group(struct rcu_head* rcu)
+{
+    release_compressed_chunks(container_of(rcu, struct compressed_chunks, rcu));
+}
+
+/* The compressed group replaces its chunks within a short content write section (the lockless readers decompress it
+   from then on), the chunks get released later (see struct released_chunks). Returns false if out of memory, in which
+   case the group should stay uncompressed.
+*/
+static bool publish_compressed_group(struct ioctl_string_ops_channel* channel, size_t group_index,
+                                     struct compressed_chunks* group)
+{
+    struct buffer_content* const content = channel->buffer_content;
+    const size_t first_chunk_index = group_index * channel->compression_chunks_count;
+
+    if (!content->compressed_groups)
+    {
+        WRITE_ONCE(content->compressed_groups,
+                   kvcalloc(buffer_chunks_count, sizeof(struct compressed_chunks*), GFP_KERNEL));
+    }
+
+    struct released_chunks* const released = kmalloc(sizeof(struct released_chunks), GFP_KERNEL);
+
+    if (!released || !content->compressed_groups)
+    {
+        kfree(released);
+        return false;
+    }
+
+    released->chunks_count = channel->compression_chunks_count;
+
+    write_seqcount_begin(&channel->content_seqcount);
+    WRITE_ONCE(content->compressed_groups[group_index], group);
+    spin_lock(&channel->chunks_lock);
+
+    for (size_t index = 0; index < released->chunks_count; ++index)
+    {
+        released->chunks[index] = content->chunks[first_chunk_index + index];
+        WRITE_ONCE(content->chunks[first_chunk_index + index], NULL);
+    }
+
+    spin_unlock(&channel->chunks_lock);
+    write_seqcount_end(&channel->content_seqcount);
+
+    // no unmapping required, the data buffer cannot be mapped while compression is enabled
+    call_srcu(&channel->readers_srcu, &released->rcu, free_released_chunks);
+
+    return true;
+}
+
+/* Should be called each time the data buffer grows (all chunks below the data buffer length are allocated), outside of
+   any content write section: the lockless readers are only blocked while each compressed group gets published.
+*/
+static void seal_data_buffer_groups(struct ioctl_string_ops_channel* channel)
+{
+    const size_t group_chars_count = channel->compression_chunks_count * BUFFER_CHUNK_SIZE;
+
+    while (channel->compression_chunks_count > 0 &&
+           (channel->sealed_groups_count + 1) * group_chars_count <= channel->buffer_length)
+    {
+        const size_t first_chunk_index = channel->sealed_groups_count * channel->compression_chunks_count;
+        struct compressed_chunks* group = NULL;
+
+        // a group that cannot be compressed (no memory saved or no memory available) stays uncompressed
+        if (compress_chunks(&channel->compression_buffers, channel->buffer_content->chunks + first_chunk_index,
+                            channel->compression_chunks_count, &group) == 0 &&
+            !publish_compressed_group(channel, channel->sealed_groups_count, group))
+        {
+            release_compressed_chunks(group);
+        }
+
+        ++channel->sealed_groups_count;
+    }
+}
+
+/* The compressed groups of an unpublished content are released once the lockless readers are done with them, the
+   content itself being kept as spare (see write_to_data_buffer()).
+*/
+static void drop_compressed_groups(struct ioctl_string_ops_channel* channel, struct buffer_content* content,
+                                   size_t groups_count)
+{
+    struct compressed_chunks** const groups = content ? content->compressed_groups : NULL;
+
+    for (size_t group_index = 0; groups && group_index < groups_count; ++group_index)
+    {
+        struct compressed_chunks* const group = groups[group_index];
+
+        if (group)
+        {
+            WRITE_ONCE(groups[group_index], NULL);
+            call_srcu(&channel->readers_srcu, &group->rcu, free_compressed_group);
+        }
+    }
+}
+
+/* The compressed groups are stored back into regular chunks (required before changing the chunk size or disabling
+   compression), each group being replaced by its chunks as a whole. On failure the groups that could not be restored
+   remain compressed, the content is not affected.
+*/
+static int restore_compressed_groups(struct ioctl_string_ops_channel* channel)
+{
+    int result = 0;
+
+    struct buffer_content* const content = channel->buffer_content;
+    const size_t chunks_count = channel->compression_chunks_count;
+
+    for (size_t group_index = 0; group_index < channel->sealed_groups_count && result == 0; ++group_index)
+    {
+        struct compressed_chunks* const group =
+            content->compressed_groups ? content->compressed_groups[group_index] : NULL;
+
+        if (!group)
+        {
+            continue;
+        }
+
+        const char* const group_content = decompress_chunks(&channel->compression_buffers, group);
+        char* restored_chunks[MAX_COMPRESSION_CHUNK_PAGES];
+        size_t restored_chunks_count = 0;
+
+        while (group_content && restored_chunks_count < chunks_count)
+        {
+            char* const chunk = (char*)__get_free_page(GFP_KERNEL);
+
+            if (!chunk)
+            {
+                break;
+            }
+
+            memcpy(chunk, group_content + restored_chunks_count * BUFFER_CHUNK_SIZE, BUFFER_CHUNK_SIZE);
+            restored_chunks[restored_chunks_count++] = chunk;
+        }
+
+        if (restored_chunks_count < chunks_count)
+        {
+            result = group_content ? -ENOMEM : -EIO;
+
+            while (restored_chunks_count > 0)
+            {
+                free_page((unsigned long)restored_chunks[--restored_chunks_count]);
+            }
+
+            break;
+        }
+
+        const size_t first_chunk_index = group_index * chunks_count;
+
+        write_seqcount_begin(&channel->content_seqcount);
+        spin_lock(&channel->chunks_lock);
+
+        for (size_t index = 0; index < chunks_count; ++index)
+        {
+            WRITE_ONCE(content->chunks[first_chunk_index + index], restored_chunks[index]);
+        }
+
+        spin_unlock(&channel->chunks_lock);
+        WRITE_ONCE(content->compressed_groups[group_index], NULL);
+        write_seqcount_end(&channel->content_seqcount);
+
+        reset_decompression_cache(&channel->compression_buffers);
+        call_srcu(&channel->readers_srcu, &group->rcu, free_compressed_group);
+    }
+
+    return result;
+}
+
+// should be called once no group is stored compressed anymore (restored or dropped along with the content)
+static void disable_compression(struct ioctl_string_ops_channel* channel)
+{
+    free_compression_buffers(&channel->compression_buffers);
+
+    write_seqcount_begin(&channel->content_seqcount);
+    WRITE_ONCE(channel->compression_chunks_count, 0);
+    write_seqcount_end(&channel->content_seqcount);
+
+    channel->sealed_groups_count = 0;
+}
+
+/* Returns -EBUSY if the data buffer is mapped (the fault handler provides regular chunks only). The mappings mutex is
+   held while enabling, so no mapping gets added meanwhile (see add_data_buffer_mapping()). The groups located below the
+   data buffer length get sealed right away.
+*/
+static int enable_compression(struct ioctl_string_ops_channel* channel, size_t chunks_count)
+{
+    int result = allocate_compression_buffers(&channel->compression_buffers, chunks_count);
+
+    if (result == 0)
+    {
+        mutex_lock(&channel->mappings_mutex);
+
+        if (list_empty(&channel->mappings))
+        {
+            write_seqcount_begin(&channel->content_seqcount);
+            WRITE_ONCE(channel->compression_chunks_count, chunks_count);
+            write_seqcount_end(&channel->content_seqcount);
+        }
+        else
+        {
+            result = -EBUSY;
+        }
+
+        mutex_unlock(&channel->mappings_mutex);
+    }
+
+    if (result == 0)
+    {
+        seal_data_buffer_groups(channel);
+    }
+    else
+    {
+        free_compression_buffers(&channel->compression_buffers);
+    }
+
+    return result;
+}
+
+/***** DATA BUFFER FUNCTIONS *****/
+
+// returns the number of chars (maximum max_chars_count) that can be accessed from index without crossing a chunk border
+static size_t get_contiguous_chars_count(size_t index, size_t max_chars_count)
+{
+    const size_t chunk_chars_count = BUFFER_CHUNK_SIZE - index % BUFFER_CHUNK_SIZE;
+
+    return max_chars_count < chunk_chars_count ? max_chars_count : chunk_chars_count;
+}
+
+/* The compressed group containing the char is decompressed into the buffer of the lockless reader. The decompressed
+   content is only kept if the view is still valid afterwards (the group might have been replaced meanwhile, e.g.
+   restored or dropped along with its content).
+*/
+static const char* peek_compressed_data_address(struct ioctl_string_ops_channel* channel,
+                                                const struct output_view* view, const struct buffer_content* content,
+                                                size_t index)
+{
+    struct decompressed_group* const decompressed = view->decompressed_group;
+    struct compressed_chunks** const groups = content ? READ_ONCE(content->compressed_groups) : NULL;
+    const size_t chunks_count = READ_ONCE(channel->compression_chunks_count);
+    const size_t chunk_index = index / BUFFER_CHUNK_SIZE;
+
+    if (!decompressed || !decompressed->content || !groups || chunks_count == 0 || chunk_index >= buffer_chunks_count)
+    {
+        return NULL;
+    }
+
+    const size_t group_index = chunk_index / chunks_count;
+    const size_t group_chars_count = chunks_count * BUFFER_CHUNK_SIZE;
+
+    if (decompressed->content_generation != view->content_generation || decompressed->group_index != group_index ||
+        decompressed->chunks_count != chunks_count)
+    {
+        const struct compressed_chunks* const group = READ_ONCE(groups[group_index]);
+
+        decompressed->chunks_count = 0; // nothing valid decompressed until checked
+
+        if (!group || !decompress_chunks_to(group, decompressed->content, group_chars_count) ||
+            read_seqcount_retry(&channel->content_seqcount, view->sequence))
+        {
+            return NULL;
+        }
+
+        decompressed->content_generation = view->content_generation;
+        decompressed->group_index = group_index;
+        decompressed->chunks_count = chunks_count;
+    }
+
+    return decompressed->content + index % group_chars_count;
+}
+
+/* Lockless variant of get_data_buffer_address() (no allocation, compressed groups decompressed by the reader): returns
+   NULL if the chunk is not available (e.g. released meanwhile), the caller should discard its snapshot in that case.
+*/
+static const char* peek_data_buffer_address(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                                            size_t index)
+{
+    const struct buffer_content* const content = READ_ONCE(channel->buffer_content);
+    const size_t chunk_index = index / BUFFER_CHUNK_SIZE;
+    const char* const chunk =
+        content && chunk_index < buffer_chunks_count ? READ_ONCE(content->chunks[chunk_index]) : NULL;
+
+    return chunk ? chunk + index % BUFFER_CHUNK_SIZE : peek_compressed_data_address(channel, view, content, index);
+}
+
+static const char* get_view_data_address(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                                         size_t index)
+{
+    return view->is_lockless ? peek_data_buffer_address(channel, view, index)
+                             : get_data_buffer_address(channel, index);
+}
+
+// copies the data buffer chars to the user iterator chunk by chunk, returns the number of successfully copied chars
+static size_t copy_data_buffer_to_iter(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                                       struct iov_iter* to, size_t index, size_t chars_count)
+{
+    size_t copied_chars_count = 0;
+
+    while (copied_chars_count < chars_count)
+    {
+        const size_t current_index = index + copied_chars_count;
+        const size_t segment_chars_count = get_contiguous_chars_count(current_index, chars_count - copied_chars_count);
+        const char* segment_address = get_view_data_address(channel, view, current_index);
+
+        const size_t segment_copied_chars_count =
+            segment_address ? copy_to_iter(segment_address, segment_chars_count, to) : 0;
+
+        copied_chars_count += segment_copied_chars_count;
+
+        if (segment_copied_chars_count < segment_chars_count)
+        {
+            break;
+        }
+    }
+
+    return copied_chars_count;
+}
+
+static size_t get_leading_whitespaces_count(const char* str, size_t length)
+{
+    size_t count = 0;
+
+    while (count < length && isspace(str[count]))
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+// the chars should be stored within regular chunks of the content (e.g. just written)
+static size_t get_content_trailing_whitespaces_count(const struct buffer_content* content, size_t index,
+                                                     size_t chars_count)
+{
+    size_t count = 0;
+
+    while (count < chars_count)
+    {
+        const size_t char_index = index + chars_count - 1 - count;
+
+        if (!isspace(content->chunks[char_index / BUFFER_CHUNK_SIZE][char_index % BUFFER_CHUNK_SIZE]))
+        {
+            break;
+        }
+
+        ++count;
+    }
+
+    return count;
+}
+
+/* The user input is copied only once, straight to its destination, where the lockless readers don't look yet:
+   - append mode: right after the existing content, i.e. beyond the data buffer length
+   - overwrite mode: at the beginning of the spare content, which replaces the existing one once complete
+   Only the new length (and content) get published within the content write section, after copying. The input is
+   copied chunk by chunk, new chunks being allocated when the content grows beyond the allocated ones. The user iterator
+   might consist of multiple segments (e.g. writev()), they are handled as a single input.
+   When trimming is enabled, the leading whitespaces are dropped while copying (the freed space is refilled from the
+   remaining user input) and the trailing ones once the whole input got copied. Returns the number of chars consumed
+   from user input.
+*/
+static ssize_t write_to_data_buffer(struct ioctl_string_ops_channel* channel, struct iov_iter* from,
+                                    size_t input_chars_count)
+{
+    const bool should_trim = channel->settings & TRIM_USER_INPUT_ENABLED;
+    const bool should_append = channel->settings & USER_INPUT_APPENDING_ENABLED;
+
+    const size_t start_index = should_append ? channel->buffer_length : 0;
+    const size_t available_chars_count = buffer_capacity - start_index;
+
+    if (should_append && !channel->buffer_content)
+    {
+        struct buffer_content* const content = allocate_buffer_content();
+
+        spin_lock(&channel->chunks_lock);
+        WRITE_ONCE(channel->buffer_content, content); // empty, nothing to be read yet
+        spin_unlock(&channel->chunks_lock);
+    }
+
+    if (!should_append && !channel->spare_content)
+    {
+        channel->spare_content = allocate_buffer_content();
+    }
+
+    struct buffer_content* const content = should_append ? channel->buffer_content : channel->spare_content;
+
+    if (!content)
+    {
+        pr_err("%s: unable to allocate memory for the data buffer content!\n", THIS_MODULE->name);
+        return -ENOMEM;
+    }
+
+    size_t consumed_chars_count = 0;
+    size_t stored_chars_count = 0;
+    bool is_copy_failed = false;
+
+    // the input is stored as provided by user (binary-safe), i.e. any '\0' chars are stored as well
+    while (!is_copy_failed && consumed_chars_count < input_chars_count && stored_chars_count < available_chars_count)
+    {
+        const size_t current_index = start_index + stored_chars_count;
+        char* const current_destination = get_write_destination(channel, content, current_index);
+
+        if (!current_destination)
+        {
+            pr_err("%s: unable to allocate memory for a new data buffer chunk!\n", THIS_MODULE->name);
+            break;
+        }
+
+        const size_t remaining_input_chars_count = input_chars_count - consumed_chars_count;
+        const size_t free_chars_count = available_chars_count - stored_chars_count;
+        const size_t bytes_to_copy_count = get_contiguous_chars_count(
+            current_index,
+            remaining_input_chars_count < free_chars_count ? remaining_input_chars_count : free_chars_count);
+        const size_t copied_chars_count = copy_from_iter(current_destination, bytes_to_copy_count, from);
+
+        if (copied_chars_count < bytes_to_copy_count)
+        {
+            pr_warn("%s: %lu bytes could not be copied from user\n", THIS_MODULE->name,
+                    bytes_to_copy_count - copied_chars_count);
+            is_copy_failed = true;
+        }
+
+        const bool should_skip_whitespaces = should_trim && stored_chars_count == 0; // leading whitespaces only
+        const size_t skipped_chars_count =
+            should_skip_whitespaces ? get_leading_whitespaces_count(current_destination, copied_chars_count) : 0;
+
+        if (skipped_chars_count > 0)
+        {
+            memmove(current_destination, current_destination + skipped_chars_count,
+                    copied_chars_count - skipped_chars_count);
+        }
+
+        consumed_chars_count += copied_chars_count;
+        stored_chars_count += copied_chars_count - skipped_chars_count;
+    }
+
+    const bool is_input_fully_consumed = consumed_chars_count == input_chars_count;
+
+    // when the input got truncated the trailing whitespaces of the stored chars are not trailing within the input
+    if (should_trim && is_input_fully_consumed)
+    {
+        stored_chars_count -= get_content_trailing_whitespaces_count(content, start_index, stored_chars_count);
+    }
+
+    if (should_append)
+    {
+        // the appended chars become visible to the lockless readers all at once
+        write_seqcount_begin(&channel->content_seqcount);
+        WRITE_ONCE(channel->buffer_length, start_index + stored_chars_count);
+        write_seqcount_end(&channel->content_seqcount);
+    }
+    else
+    {
+        const size_t old_sealed_groups_count = channel->sealed_groups_count;
+
+        channel->spare_content = publish_data_buffer_content(channel, content, stored_chars_count);
+        drop_compressed_groups(channel, channel->spare_content, old_sealed_groups_count);
+    }
+
+    seal_data_buffer_groups(channel);
+
+    if (!is_input_fully_consumed && !is_copy_failed)
+    {
+        increment_counter(COUNTER_TRUNCATED_WRITES);
+        pr_warn("%s: not all input could be appended to the driver buffer. There is not enough space. %lu "
+                "characters got appended out of %lu.\n",
+                THIS_MODULE->name, stored_chars_count, input_chars_count);
+    }
+
+    hot_path_info("%s: %lu chars of user input have been stored, the data buffer contains %lu chars\n",
+                  THIS_MODULE->name, stored_chars_count, channel->buffer_length);
+
+    reset_max_output_size(channel);
+    notify_readers(channel);
+
+    // the total number of chars provided by user (not the trimmed one) needs to be returned
+    return is_copy_failed ? (consumed_chars_count > 0 ? (ssize_t)consumed_chars_count : -EFAULT)
+                          : (ssize_t)input_chars_count;
+}
+
+/***** STREAMING MODE FUNCTIONS *****/
+
+// copies between the user iterator and the stream fifo segments, returns the number of successfully copied chars
+static size_t copy_stream_segments(struct scatterlist* segments, unsigned int segments_count, struct iov_iter* iter,
+                                   bool should_copy_to_stream)
+{
+    size_t copied_chars_count = 0;
+
+    for (unsigned int segment_index = 0; segment_index < segments_count; ++segment_index)
+    {
+        void* const segment_address = sg_virt(&segments[segment_index]);
+        const size_t segment_chars_count = segments[segment_index].length;
+        const size_t segment_copied_chars_count = should_copy_to_stream
+                                                      ? copy_from_iter(segment_address, segment_chars_count, iter)
+                                                      : copy_to_iter(segment_address, segment_chars_count, iter);
+
+        copied_chars_count += segment_copied_chars_count;
+
+        if (segment_copied_chars_count < segment_chars_count)
+        {
+            break;
+        }
+    }
+
+    return copied_chars_count;
+}
+
+// should be called with the stream read mutex held
+static ssize_t dequeue_from_stream(struct ioctl_string_ops_channel* channel, struct iov_iter* to)
+{
+    ssize_t read_bytes_count = 0;
+
+    do
+    {
+        struct scatterlist segments[STREAM_SEGMENTS_COUNT];
+        sg_init_table(segments, STREAM_SEGMENTS_COUNT);
+
+        const size_t length = iov_iter_count(to);
+        const unsigned int segments_count =
+            kfifo_dma_out_prepare(&channel->stream_fifo, segments, STREAM_SEGMENTS_COUNT, length);
+        const size_t copied_chars_count = copy_stream_segments(segments, segments_count, to, false);
+
+        kfifo_dma_out_finish(&channel->stream_fifo, copied_chars_count);
+
+        if (copied_chars_count == 0 && length > 0)
+        {
+            pr_err("%s: failed copying the stream output to user!\n", THIS_MODULE->name);
+            read_bytes_count = -EFAULT;
+            break;
+        }
+
+        read_bytes_count = (ssize_t)copied_chars_count;
+        notify_writers(channel);
+    } while (false);
+
+    return read_bytes_count;
+}
+
+// the chars are dequeued by copying them straight from the stream fifo memory to the user iterator
+static ssize_t read_from_stream(struct ioctl_string_ops_channel* channel, struct kiocb* iocb, struct iov_iter* to)
+{
+    ssize_t read_bytes_count = 0;
+
+    do
+    {
+        read_bytes_count = wait_for_data(channel, iocb);
+
+        if (read_bytes_count < 0)
+        {
+            break;
+        }
+
+        if (mutex_lock_interruptible(&channel->stream_read_mutex))
+        {
+            read_bytes_count = -ERESTARTSYS;
+            break;
+        }
+
+        if (!is_stream_fifo_usable(channel))
+        {
+            read_bytes_count = -EIO;
+        }
+        // another reader might have emptied the fifo meanwhile
+        else if (!kfifo_is_empty(&channel->stream_fifo))
+        {
+            read_bytes_count = dequeue_from_stream(channel, to);
+        }
+
+        mutex_unlock(&channel->stream_read_mutex);
+    } while (read_bytes_count == 0 && iov_iter_count(to) > 0 && is_streaming_mode_enabled(channel));
+
+    return read_bytes_count;
+}
+
+// should be called with the stream write mutex held
+static ssize_t enqueue_to_stream(struct ioctl_string_ops_channel* channel, struct iov_iter* from)
+{
+    ssize_t written_bytes_count = 0;
+
+    do
+    {
+        struct scatterlist segments[STREAM_SEGMENTS_COUNT];
+        sg_init_table(segments, STREAM_SEGMENTS_COUNT);
+
+        const size_t length = iov_iter_count(from);
+        const unsigned int segments_count =
+            kfifo_dma_in_prepare(&channel->stream_fifo, segments, STREAM_SEGMENTS_COUNT, length);
+        const size_t copied_chars_count = copy_stream_segments(segments, segments_count, from, true);
+
+        kfifo_dma_in_finish(&channel->stream_fifo, copied_chars_count);
+
+        if (copied_chars_count == 0 && length > 0)
+        {
+            pr_err("%s: failed copying the stream input from user!\n", THIS_MODULE->name);
+            written_bytes_count = -EFAULT;
+            break;
+        }
+
+        written_bytes_count = (ssize_t)copied_chars_count;
+        notify_readers(channel);
+    } while (false);
+
+    return written_bytes_count;
+}
+
+// the chars are enqueued by copying them straight from the user iterator to the stream fifo memory (as many as fit)
+static ssize_t write_to_stream(struct ioctl_string_ops_channel* channel, struct kiocb* iocb, struct iov_iter* from)
+{
+    ssize_t written_bytes_count = 0;
+
+    do
+    {
+        written_bytes_count = wait_for_space(channel, iocb, 1);
+
+        if (written_bytes_count < 0)
+        {
+            break;
+        }
+
+        if (mutex_lock_interruptible(&channel->stream_write_mutex))
+        {
+            written_bytes_count = -ERESTARTSYS;
+            break;
+        }
+
+        if (!is_stream_fifo_usable(channel))
+        {
+            written_bytes_count = -EIO;
+        }
+        // another writer might have filled the fifo meanwhile
+        else if (!kfifo_is_full(&channel->stream_fifo))
+        {
+            written_bytes_count = enqueue_to_stream(channel, from);
+        }
+
+        mutex_unlock(&channel->stream_write_mutex);
+    } while (written_bytes_count == 0 && iov_iter_count(from) > 0 && is_streaming_mode_enabled(channel));
+
+    return written_bytes_count;
+}
+
+/***** RECORD MODE FUNCTIONS *****/
+
+// the record length is stored within the queue too, so the queue capacity might limit the record size even further
+static size_t get_max_record_size(struct ioctl_string_ops_channel* channel)
+{
+    const size_t queue_capacity = kfifo_size(&channel->record_queue) - sizeof(u16);
+
+    return queue_capacity < MAX_RECORD_SIZE ? queue_capacity : MAX_RECORD_SIZE;
+}
+
+// should be called with the stream read mutex held, the next record should fit into the user iterator
+static ssize_t dequeue_record(struct ioctl_string_ops_channel* channel, struct iov_iter* to)
+{
+    ssize_t read_bytes_count = -EFAULT;
+
+    struct scatterlist segments[STREAM_SEGMENTS_COUNT];
+    sg_init_table(segments, STREAM_SEGMENTS_COUNT);
+
+    const size_t record_size = kfifo_peek_len(&channel->record_queue);
+    const unsigned int segments_count =
+        kfifo_dma_out_prepare(&channel->record_queue, segments, STREAM_SEGMENTS_COUNT, record_size);
+
+    // the record is kept queued if it couldn't be copied as a whole
+    if (copy_stream_segments(segments, segments_count, to, false) == record_size)
+    {
+        kfifo_dma_out_finish(&channel->record_queue, record_size);
+        read_bytes_count = (ssize_t)record_size;
+        notify_writers(channel);
+    }
+    else
+    {
+        pr_err("%s: failed copying the record to user!\n", THIS_MODULE->name);
+    }
+
+    return read_bytes_count;
+}
+
+// should be called with the stream write mutex held, the record queue should have enough space for the record
+static ssize_t enqueue_record(struct ioctl_string_ops_channel* channel, struct iov_iter* from, size_t record_size)
+{
+    ssize_t written_bytes_count = -EFAULT;
+
+    struct scatterlist segments[STREAM_SEGMENTS_COUNT];
+    sg_init_table(segments, STREAM_SEGMENTS_COUNT);
+
+    const unsigned int segments_count =
+        kfifo_dma_in_prepare(&channel->record_queue, segments, STREAM_SEGMENTS_COUNT, record_size);
+
+    // the record only becomes visible to readers if copied as a whole
+    if (copy_stream_segments(segments, segments_count, from, true) == record_size)
+    {
+        kfifo_dma_in_finish(&channel->record_queue, record_size);
+        written_bytes_count = (ssize_t)record_size;
+        notify_readers(channel);
+    }
+    else
+    {
+        pr_err("%s: failed copying the record from user!\n", THIS_MODULE->name);
+    }
+
+    return written_bytes_count;
+}
+
+// each read provides exactly one record, if the user buffer is too small the record is kept queued (-EMSGSIZE)
+static ssize_t read_from_record_queue(struct ioctl_string_ops_channel* channel, struct kiocb* iocb, struct iov_iter* to)
+{
+    ssize_t read_bytes_count = 0;
+    bool should_retry = false;
+
+    do
+    {
+        read_bytes_count = wait_for_data(channel, iocb);
+
+        if (read_bytes_count < 0)
+        {
+            break;
+        }
+
+        if (mutex_lock_interruptible(&channel->stream_read_mutex))
+        {
+            read_bytes_count = -ERESTARTSYS;
+            break;
+        }
+
+        const bool is_queue_usable = is_record_queue_usable(channel);
+
+        // another reader might have emptied the queue meanwhile
+        should_retry = is_queue_usable && kfifo_is_empty(&channel->record_queue);
+
+        if (!is_queue_usable)
+        {
+            read_bytes_count = -EIO;
+        }
+        else if (!should_retry)
+        {
+            read_bytes_count =
+                kfifo_peek_len(&channel->record_queue) > iov_iter_count(to) ? -EMSGSIZE : dequeue_record(channel, to);
+        }
+
+        mutex_unlock(&channel->stream_read_mutex);
+    } while (should_retry && is_record_mode_enabled(channel));
+
+    return read_bytes_count;
+}
+
+// the whole user input becomes one record (no trimming), empty input is ignored
+static ssize_t write_to_record_queue(struct ioctl_string_ops_channel* channel, struct kiocb* iocb,
+                                     struct iov_iter* from)
+{
+    ssize_t written_bytes_count = 0;
+    bool should_retry = false;
+
+    const size_t record_size = iov_iter_count(from);
+
+    do
+    {
+        if (record_size == 0)
+        {
+            break;
+        }
+
+        if (record_size > get_max_record_size(channel))
+        {
+            written_bytes_count = -EMSGSIZE;
+            break;
+        }
+
+        written_bytes_count = wait_for_space(channel, iocb, record_size);
+
+        if (written_bytes_count < 0)
+        {
+            break;
+        }
+
+        if (mutex_lock_interruptible(&channel->stream_write_mutex))
+        {
+            written_bytes_count = -ERESTARTSYS;
+            break;
+        }
+
+        const bool is_queue_usable = is_record_queue_usable(channel);
+
+        // another writer might have filled the queue meanwhile
+        should_retry = is_queue_usable && kfifo_avail(&channel->record_queue) < record_size;
+
+        if (!is_queue_usable)
+        {
+            written_bytes_count = -EIO;
+        }
+        else if (!should_retry)
+        {
+            written_bytes_count = enqueue_record(channel, from, record_size);
+        }
+
+        mutex_unlock(&channel->stream_write_mutex);
+    } while (should_retry && is_record_mode_enabled(channel));
+
+    return written_bytes_count;
+}
+
+/***** OUTPUT READING FUNCTIONS *****/
+
+// should be called with the data mutex held or within a lockless read section (validated by the caller)
+static void get_output_view(struct ioctl_string_ops_channel* channel, bool is_lockless, struct output_view* view)
+{
+    const struct output_prefix* const prefix = READ_ONCE(channel->output_prefix);
+
+    view->prefix = prefix ? prefix->chars : NULL;
+    view->prefix_length = READ_ONCE(channel->output_prefix_length);
+    view->buffer_length = READ_ONCE(channel->buffer_length);
+    view->content_generation = READ_ONCE(channel->content_generation);
+    view->is_lockless = is_lockless;
+    view->sequence = 0;
+    view->decompressed_group = NULL;
+}
+
+/* The output is sent to user in two segments, no intermediate (consolidated) buffer required:
+   - the output prefix chars starting with prefix_index
+   - maximum data_chars_count chars read from the data buffer starting with data_index (copied chunk by chunk)
+   The user iterator might consist of multiple segments as well (e.g. readv()), the output is scattered across them in
+   order. Returns the number of chars sent to user.
+*/
+static ssize_t copy_output_to_iter(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                                   struct iov_iter* to, size_t prefix_index, size_t data_index,
+                                   size_t data_chars_count)
+{
+    ssize_t read_bytes_count = -EFAULT;
+
+    const size_t length = iov_iter_count(to);
+    const size_t prefix_chars_count = view->prefix_length - prefix_index;
+    const size_t prefix_chars_to_read_count = length < prefix_chars_count ? length : prefix_chars_count;
+    const size_t remaining_length = length - prefix_chars_to_read_count;
+    const size_t data_chars_to_read_count = remaining_length < data_chars_count ? remaining_length : data_chars_count;
+
+    if (copy_to_iter(view->prefix + prefix_index, prefix_chars_to_read_count, to) < prefix_chars_to_read_count ||
+        copy_data_buffer_to_iter(channel, view, to, data_index, data_chars_to_read_count) <
+            data_chars_to_read_count)
+    {
+        // a lockless reader might miss chunks released meanwhile, the snapshot gets discarded anyway
+        if (!view->is_lockless)
+        {
+            pr_err("%s: failed copying the output to user!\n", THIS_MODULE->name);
+        }
+    }
+    else
+    {
+        read_bytes_count = (ssize_t)(prefix_chars_to_read_count + data_chars_to_read_count);
+
+        if (prefix_chars_to_read_count > 0)
+        {
+            increment_counter(COUNTER_PREFIXED_READS);
+        }
+
+        hot_path_info("%s: user read %ld chars\n", THIS_MODULE->name, read_bytes_count);
+    }
+
+    return read_bytes_count;
+}
+
+static void free_read_filter(struct read_filter* filter)
+{
+    if (filter)
+    {
+        kfree(filter->pattern);
+        kfree(filter->line);
+        kfree(filter);
+    }
+}
+
+// the pattern is copied from user, returns NULL if the filter is invalid or cannot be allocated
+static struct read_filter* create_read_filter(const struct ioctl_string_ops_read_filter* read_filter)
+{
+    struct read_filter* filter = NULL;
+
+    do
+    {
+        if (read_filter->type != READ_FILTER_SUBSTRING && read_filter->type != READ_FILTER_GLOB)
+        {
+            pr_err("%s: IOCTL: unsupported read filter type: %u\n", THIS_MODULE->name, read_filter->type);
+            break;
+        }
+
+        if (read_filter->pattern_size > MAX_READ_FILTER_PATTERN_SIZE)
+        {
+            pr_err("%s: IOCTL: the read filter pattern is too long!\n", THIS_MODULE->name);
+            break;
+        }
+
+        filter = kzalloc(sizeof(struct read_filter), GFP_KERNEL);
+
+        if (!filter)
+        {
+            break;
+        }
+
+        filter->type = read_filter->type;
+        filter->pattern_length = read_filter->pattern_size;
+        filter->pattern = kmalloc(filter->pattern_length + 1, GFP_KERNEL);
+        filter->line = kmalloc(MAX_READ_FILTER_LINE_SIZE + 1, GFP_KERNEL);
+
+        if (!filter->pattern || !filter->line ||
+            copy_from_user(filter->pattern, read_filter->pattern, filter->pattern_length) > 0)
+        {
+            pr_err("%s: IOCTL: failed setting up the read filter!\n", THIS_MODULE->name);
+            free_read_filter(filter);
+            filter = NULL;
+            break;
+        }
+
+        filter->pattern[filter->pattern_length] = '\0';
+
+        if (filter->type == READ_FILTER_GLOB && memchr(filter->pattern, '\0', filter->pattern_length))
+        {
+            pr_err("%s: IOCTL: glob patterns cannot contain '\\0' chars!\n", THIS_MODULE->name);
+            free_read_filter(filter);
+            filter = NULL;
+        }
+    } while (false);
+
+    return filter;
+}
+
+/* Scans the data buffer line starting with index (chunk by chunk) and retrieves its length, terminating '\n' included,
+   and the length of its content ('\n' excluded). Returns false if a chunk is not available (lockless snapshot).
+*/
+static bool get_data_buffer_line_length(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                                        size_t index, size_t* line_length, size_t* content_length)
+{
+    bool is_available = true;
+    bool is_line_end_found = false;
+
+    *line_length = 0;
+
+    while (is_available && !is_line_end_found && index + *line_length < view->buffer_length)
+    {
+        const size_t current_index = index + *line_length;
+        const size_t segment_chars_count =
+            get_contiguous_chars_count(current_index, view->buffer_length - current_index);
+        const char* const segment = get_view_data_address(channel, view, current_index);
+        const char* const line_end = segment ? memchr(segment, '\n', segment_chars_count) : NULL;
+
+        is_available = segment != NULL;
+        is_line_end_found = line_end != NULL;
+        *line_length += line_end ? (size_t)(line_end - segment) + 1 : segment_chars_count;
+    }
+
+    *content_length = is_line_end_found ? *line_length - 1 : *line_length;
+
+    return is_available;
+}
+
+// the line content (maximum MAX_READ_FILTER_LINE_SIZE chars) is gathered into the filter line buffer before matching
+static bool is_line_matching(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                             struct read_filter* filter, size_t index, size_t content_length)
+{
+    const size_t line_chars_count =
+        content_length < MAX_READ_FILTER_LINE_SIZE ? content_length : MAX_READ_FILTER_LINE_SIZE;
+    size_t gathered_chars_count = 0;
+
+    while (gathered_chars_count < line_chars_count)
+    {
+        const size_t current_index = index + gathered_chars_count;
+        const size_t segment_chars_count =
+            get_contiguous_chars_count(current_index, line_chars_count - gathered_chars_count);
+        const char* const segment = get_view_data_address(channel, view, current_index);
+
+        if (!segment)
+        {
+            break;
+        }
+
+        memcpy(filter->line + gathered_chars_count, segment, segment_chars_count);
+        gathered_chars_count += segment_chars_count;
+    }
+
+    filter->line[gathered_chars_count] = '\0';
+
+    bool is_matching = false;
+
+    if (filter->type == READ_FILTER_GLOB)
+    {
+        is_matching = glob_match(filter->pattern, filter->line);
+    }
+    else
+    {
+        for (size_t char_index = 0; !is_matching && char_index + filter->pattern_length <= gathered_chars_count;
+             ++char_index)
+        {
+            is_matching = memcmp(filter->line + char_index, filter->pattern, filter->pattern_length) == 0;
+        }
+    }
+
+    return is_matching;
+}
+
+/* The matching data buffer lines starting with data_index are copied to user, the other lines are skipped. A matching
+   line partially read before (is_in_matched_line) is continued without matching. Returns the number of copied chars or
+   -EFAULT, data_index being advanced past the consumed chars (copied or skipped).
+*/
+static ssize_t copy_filtered_lines_to_iter(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                                           struct read_filter* filter, struct iov_iter* to, size_t* data_index,
+                                           bool* is_in_matched_line)
+{
+    ssize_t read_bytes_count = 0;
+
+    while (*data_index < view->buffer_length && iov_iter_count(to) > 0)
+    {
+        size_t line_length;
+        size_t content_length;
+
+        if (!get_data_buffer_line_length(channel, view, *data_index, &line_length, &content_length))
+        {
+            read_bytes_count = -EFAULT;
+            break;
+        }
+
+        if (!*is_in_matched_line && !is_line_matching(channel, view, filter, *data_index, content_length))
+        {
+            *data_index += line_length;
+            continue;
+        }
+
+        const size_t available_length = iov_iter_count(to);
+
+        // only whole lines, unless the user buffer cannot contain the line at all
+        if (line_length > available_length && read_bytes_count > 0)
+        {
+            break;
+        }
+
+        const size_t chars_to_read_count = line_length < available_length ? line_length : available_length;
+
+        if (copy_data_buffer_to_iter(channel, view, to, *data_index, chars_to_read_count) <
+            chars_to_read_count)
+        {
+            read_bytes_count = -EFAULT;
+            break;
+        }
+
+        read_bytes_count += (ssize_t)chars_to_read_count;
+        *data_index += chars_to_read_count;
+        *is_in_matched_line = chars_to_read_count < line_length;
+    }
+
+    return read_bytes_count;
+}
+
+// maximum output size set: the next window of the data buffer is provided, the reading cursor is shared by all readers
+static ssize_t read_data_buffer_window(struct ioctl_string_ops_channel* channel, struct iov_iter* to)
+{
+    struct output_view view;
+
+    get_output_view(channel, false, &view);
+
+    const size_t read_index = compute_data_buffer_current_read_index(channel);
+    const size_t available_chars_count = channel->buffer_length - read_index;
+    const size_t data_chars_count =
+        channel->max_output_size < available_chars_count ? channel->max_output_size : available_chars_count;
+    const ssize_t read_bytes_count = copy_output_to_iter(channel, &view, to, 0, read_index, data_chars_count);
+
+    if (read_bytes_count > 0)
+    {
+        const size_t data_chars_read_count =
+            (size_t)read_bytes_count > channel->output_prefix_length
+                ? (size_t)read_bytes_count - channel->output_prefix_length
+                : 0;
+
+        // defensive programming, the read data chars count should never exceed the chars left to read count
+        channel->chars_left_to_read_count =
+            data_chars_read_count < channel->chars_left_to_read_count
+                ? channel->chars_left_to_read_count - data_chars_read_count
+                : 0;
+
+        publish_buffer_offsets(channel);
+    }
+
+    if (channel->chars_left_to_read_count == 0)
+    {
+        // maximum output size to be reset to the buffer length (0 - read whole content)
+        reset_max_output_size(channel);
+    }
+
+    return read_bytes_count;
+}
+
+// file position reached by a read, only updated if the read gets accepted (see commit_read_position())
+struct read_progress
+{
+    loff_t position;
+    loff_t matched_line_position; // -1 if the read didn't stop within a matching line
+};
+
+// the output prefix is not filtered, the data buffer lines following it are (see copy_filtered_lines_to_iter())
+static ssize_t read_filtered_output(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                                    struct read_filter* filter, struct iov_iter* to, bool is_in_matched_line,
+                                    struct read_progress* progress)
+{
+    ssize_t read_bytes_count = 0;
+    size_t output_index = (size_t)progress->position;
+
+    if (output_index < view->prefix_length)
+    {
+        read_bytes_count = copy_output_to_iter(channel, view, to, output_index, 0, 0);
+        output_index += read_bytes_count > 0 ? (size_t)read_bytes_count : 0;
+    }
+
+    if (read_bytes_count >= 0 && output_index >= view->prefix_length)
+    {
+        size_t data_index = output_index - view->prefix_length;
+        const ssize_t lines_bytes_count =
+            copy_filtered_lines_to_iter(channel, view, filter, to, &data_index, &is_in_matched_line);
+
+        read_bytes_count = lines_bytes_count < 0 ? lines_bytes_count : read_bytes_count + lines_bytes_count;
+        output_index = view->prefix_length + data_index;
+    }
+
+    if (read_bytes_count >= 0)
+    {
+        progress->position = (loff_t)output_index;
+        progress->matched_line_position = is_in_matched_line ? progress->position : -1;
+    }
+
+    return read_bytes_count;
+}
+
+/* The output is read from the file position (output prefix included), no channel state is modified. When waiting for
+   data, a file whose content got replaced since its last read (subscriber) starts over from the beginning. If the file
+   has a read filter, only the matching lines are read. The file position is only updated by the caller (the read might
+   get discarded).
+*/
+static ssize_t read_data_buffer_at_position(struct ioctl_string_ops_channel* channel, const struct output_view* view,
+                                            const struct kiocb* iocb, struct iov_iter* to,
+                                            struct read_progress* progress)
+{
+    ssize_t read_bytes_count = 0;
+
+    const struct reader_data* reader = iocb->ki_filp->private_data;
+    const bool is_replaced = READ_ONCE(reader->content_generation) != view->content_generation;
+
+    progress->position = (READ_ONCE(channel->settings) & WAIT_FOR_DATA_ENABLED) && is_replaced ? 0 : iocb->ki_pos;
+    progress->matched_line_position = -1;
+
+    const size_t output_index = (size_t)progress->position;
+
+    if (reader->filter)
+    {
+        const bool is_in_matched_line = !is_replaced && reader->matched_line_position == progress->position;
+
+        read_bytes_count = read_filtered_output(channel, view, reader->filter, to, is_in_matched_line, progress);
+    }
+    else if (output_index < view->prefix_length)
+    {
+        read_bytes_count = copy_output_to_iter(channel, view, to, output_index, 0, view->buffer_length);
+    }
+    else if (output_index < view->prefix_length + view->buffer_length)
+    {
+        const size_t data_index = output_index - view->prefix_length;
+
+        read_bytes_count =
+            copy_output_to_iter(channel, view, to, view->prefix_length, data_index, view->buffer_length - data_index);
+    }
+
+    if (!reader->filter && read_bytes_count > 0)
+    {
+        progress->position += read_bytes_count;
+    }
+
+    return read_bytes_count;
+}
+
+// the read is accepted: the file position and the content generation it refers to are updated
+static void commit_read_position(const struct output_view* view, struct kiocb* iocb,
+                                 const struct read_progress* progress)
+{
+    struct reader_data* reader = iocb->ki_filp->private_data;
+
+    WRITE_ONCE(reader->content_generation, view->content_generation);
+    reader->matched_line_position = progress->matched_line_position;
+    iocb->ki_pos = progress->position;
+}
+
+/* The compressed groups are decompressed by the lockless reader into its own buffer, allocated on the first read with
+   compression enabled (the compressed groups are read under the data mutex if the allocation failed).
+*/
+static struct decompressed_group* get_decompressed_group(struct ioctl_string_ops_channel* channel,
+                                                         struct reader_data* reader)
+{
+    struct decompressed_group* const decompressed = &reader->decompressed_group;
+
+    if (!decompressed->content && READ_ONCE(channel->compression_chunks_count) > 0)
+    {
+        decompressed->content = kvmalloc(MAX_COMPRESSION_CHUNK_PAGES * BUFFER_CHUNK_SIZE, GFP_KERNEL);
+        decompressed->chunks_count = 0;
+    }
+
+    return decompressed;
+}
+
+/* Lockless reading from the file position (see struct ioctl_string_ops_channel). Returns false if no consistent
+   snapshot could be taken (the caller should read under the data mutex), the iterator being reverted in that case.
+   Chunks missing from the snapshot (e.g. released meanwhile) invalidate it as well.
+*/
+static bool read_data_buffer_snapshot(struct ioctl_string_ops_channel* channel, struct kiocb* iocb,
+                                      struct iov_iter* to, ssize_t* read_bytes_count)
+{
+    bool is_consistent = false;
+
+    struct decompressed_group* const decompressed_group = get_decompressed_group(channel, iocb->ki_filp->private_data);
+    const int srcu_index = srcu_read_lock(&channel->readers_srcu);
+
+    for (int attempt = 0; attempt < MAX_SNAPSHOT_READ_ATTEMPTS && !is_consistent; ++attempt)
+    {
+        // the sequence is odd while a writer is active, the snapshot is discarded without waiting
+        const unsigned int sequence = raw_seqcount_begin(&channel->content_seqcount);
+        struct output_view view;
+
+        get_output_view(channel, true, &view);
+        view.sequence = sequence;
+        view.decompressed_group = decompressed_group;
+
+        // the view should be consistent before copying anything (e.g. prefix length matching the prefix)
+        if (read_seqcount_retry(&channel->content_seqcount, sequence))
+        {
+            continue;
+        }
+
+        const size_t initial_length = iov_iter_count(to);
+        struct read_progress progress;
+        const ssize_t copied_bytes_count = read_data_buffer_at_position(channel, &view, iocb, to, &progress);
+
+        is_consistent = copied_bytes_count >= 0 && !read_seqcount_retry(&channel->content_seqcount, sequence);
+
+        if (is_consistent)
+        {
+            commit_read_position(&view, iocb, &progress);
+            *read_bytes_count = copied_bytes_count;
+        }
+        else
+        {
+            iov_iter_revert(to, initial_length - iov_iter_count(to));
+        }
+    }
+
+    srcu_read_unlock(&channel->readers_srcu, srcu_index);
+
+    return is_consistent;
+}
+
+/* Reading from the file position doesn't modify the channel, so it is first attempted without the data mutex. An empty
+   snapshot read while waiting for data is rechecked under the data mutex (content replaced meanwhile). Retrying is
+   required if there is nothing to read (anymore) or if all lines got filtered out while waiting for data.
+*/
+static ssize_t try_read_from_data_buffer(struct ioctl_string_ops_channel* channel, struct kiocb* iocb,
+                                         struct iov_iter* to, bool* should_retry)
+{
+    ssize_t read_bytes_count = 0;
+
+    const bool is_waiting_enabled = READ_ONCE(channel->settings) & WAIT_FOR_DATA_ENABLED;
+
+    *should_retry = false;
+
+    if (READ_ONCE(channel->max_output_size) == 0 && read_data_buffer_snapshot(channel, iocb, to, &read_bytes_count) &&
+        (read_bytes_count != 0 || !is_waiting_enabled))
+    {
+        // consistent snapshot read
+    }
+    else if (mutex_lock_interruptible(&channel->data_mutex))
+    {
+        read_bytes_count = -ERESTARTSYS;
+    }
+    else
+    {
+        *should_retry = !is_data_available_for_reading(channel, iocb->ki_filp, iocb->ki_pos);
+
+        if (*should_retry)
+        {
+            // nothing to read
+        }
+        else if (channel->max_output_size > 0)
+        {
+            read_bytes_count = read_data_buffer_window(channel, to);
+        }
+        else
+        {
+            struct output_view view;
+            struct read_progress progress;
+
+            get_output_view(channel, false, &view);
+            read_bytes_count = read_data_buffer_at_position(channel, &view, iocb, to, &progress);
+
+            if (read_bytes_count >= 0)
+            {
+                commit_read_position(&view, iocb, &progress);
+                *should_retry = read_bytes_count == 0 && is_waiting_enabled;
+            }
+        }
+
+        mutex_unlock(&channel->data_mutex);
+    }
+
+    return read_bytes_count;
+}
+
+/* The data is waited for without holding the data mutex, another file might change the output meanwhile (recheck).
+   The read mutex of the file keeps its read filter and position consistent for the whole read.
+*/
+static ssize_t read_from_data_buffer(struct ioctl_string_ops_channel* channel, struct kiocb* iocb, struct iov_iter* to)
+{
+    ssize_t read_bytes_count = 0;
+    bool should_retry = false;
+
+    struct reader_data* reader = iocb->ki_filp->private_data;
+
+    do
+    {
+        read_bytes_count = wait_for_data(channel, iocb);
+
+        if (read_bytes_count < 0)
+        {
+            break;
+        }
+
+        if (mutex_lock_interruptible(&reader->read_mutex))
+        {
+            read_bytes_count = -ERESTARTSYS;
+            break;
+        }
+
+        read_bytes_count = try_read_from_data_buffer(channel, iocb, to, &should_retry);
+
+        mutex_unlock(&reader->read_mutex);
+    } while (should_retry && read_bytes_count >= 0);
+
+    return read_bytes_count;
+}
+
+/***** CHANNEL FUNCTIONS *****/
+
+// the channel gets back to its initial (idle) state, releasing any memory allocated on demand except the header page
+static void reset_channel_data(struct ioctl_string_ops_channel* channel)
+{
+    free_data_buffer_contents(channel);
+    reset_max_output_size(channel);
+
+    update_settings(channel, DEFAULT_SETTINGS); // waiting for data, streaming and record mode are disabled by default
+
+    disable_compression(channel); // disabled by default as well
+    replace_output_prefix(channel, NULL, 0);
+    free_queues(channel);
+}
+
+/***** OPEN/RELEASE IMPLEMENTATION FUNCTIONS *****/
+
+int device_open_impl(struct inode* inode, struct file* filp)
+{
+    int result = -ENODEV;
+    const unsigned int minor_number = iminor(inode);
+
+    if (minor_number < channels_count)
+    {
+        struct reader_data* reader = kzalloc(sizeof(struct reader_data), GFP_KERNEL);
+
+        if (reader)
+        {
+            reader->channel = &channels[minor_number];
+            reader->content_generation = READ_ONCE(reader->channel->content_generation);
+            reader->matched_line_position = -1;
+            mutex_init(&reader->read_mutex);
+            filp->private_data = reader;
+            result = 0;
+        }
+        else
+        {
+            result = -ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+void device_release_impl(struct inode* inode, struct file* filp)
+{
+    struct reader_data* reader = filp->private_data;
+
+    free_read_filter(reader->filter);
+    kvfree(reader->decompressed_group.content);
+    kfree(reader);
+    filp->private_data = NULL;
+}
+
+struct ioctl_string_ops_channel* get_file_channel(const struct file* filp)
+{
+    return ((const struct reader_data*)filp->private_data)->channel;
+}
+
+/***** READ/WRITE IMPLEMENTATION FUNCTIONS *****/
+
+ssize_t device_read_iter_impl(struct kiocb* iocb, struct iov_iter* to)
+{
+    struct ioctl_string_ops_channel* const channel = get_file_channel(iocb->ki_filp);
+    ssize_t result;
+
+    if (is_streaming_mode_enabled(channel))
+    {
+        result = read_from_stream(channel, iocb, to);
+    }
+    else if (is_record_mode_enabled(channel))
+    {
+        result = read_from_record_queue(channel, iocb, to);
+    }
+    else
+    {
+        result = read_from_data_buffer(channel, iocb, to);
+    }
+
+    increment_counter(COUNTER_READS);
+
+    if (result > 0)
+    {
+        add_to_counter(COUNTER_BYTES_OUT, result);
+    }
+
+    return result;
+}
+
+ssize_t device_write_iter_impl(struct kiocb* iocb, struct iov_iter* from)
+{
+    struct ioctl_string_ops_channel* const channel = get_file_channel(iocb->ki_filp);
+    ssize_t result;
+
+    if (is_streaming_mode_enabled(channel))
+    {
+        result = write_to_stream(channel, iocb, from);
+    }
+    else if (is_record_mode_enabled(channel))
+    {
+        result = write_to_record_queue(channel, iocb, from);
+    }
+    else if (mutex_lock_interruptible(&channel->data_mutex))
+    {
+        result = -ERESTARTSYS;
+    }
+    else
+    {
+        const size_t length = iov_iter_count(from);
+
+        // chars count to be accepted from user is capped no matter the subsequent operation (trim, append, etc)
+        const size_t input_chars_count = length > buffer_capacity ? buffer_capacity : length;
+
+        result = write_to_data_buffer(channel, from, input_chars_count);
+        mutex_unlock(&channel->data_mutex);
+    }
+
+    increment_counter(COUNTER_WRITES);
+
+    if (result > 0)
+    {
+        add_to_counter(COUNTER_BYTES_IN, result);
+    }
+
+    return result;
+}
+
+// the positions cover the output (prefix included), seeking is not possible in streaming/record mode (pipe-like)
+loff_t device_llseek_impl(struct file* filp, loff_t offset, int whence)
+{
+    struct ioctl_string_ops_channel* const channel = get_file_channel(filp);
+
+    return is_queue_mode_enabled(channel) ? -ESPIPE
+                                          : fixed_size_llseek(filp, offset, whence, get_output_length(channel));
+}
+
+__poll_t device_poll_impl(struct file* filp, struct poll_table_struct* wait)
+{
+    struct ioctl_string_ops_channel* const channel = get_file_channel(filp);
+    __poll_t mask = 0;
+
+    poll_wait(filp, &channel->data_wait_queue, wait);
+    poll_wait(filp, &channel->space_wait_queue, wait);
+
+    if (is_data_available_for_reading(channel, filp, READ_ONCE(filp->f_pos)))
+    {
+        mask |= EPOLLIN | EPOLLRDNORM;
+    }
+
+    if (is_space_available_for_writing(channel, 1))
+    {
+        mask |= EPOLLOUT | EPOLLWRNORM;
+    }
+
+    return mask;
+}
+
+/***** MEMORY MAPPING FUNCTIONS *****/
+
+static vm_fault_t data_buffer_vm_fault(struct vm_fault* vmf)
+{
+    struct ioctl_string_ops_channel* const channel = ((struct data_buffer_mapping*)vmf->vma->vm_private_data)->channel;
+    vm_fault_t result = VM_FAULT_SIGBUS;
+    void* page_address = NULL;
+
+    spin_lock(&channel->chunks_lock);
+
+    if (vmf->pgoff == HEADER_PAGE_OFFSET)
+    {
+        page_address = channel->buffer_header;
+    }
+    else if (channel->buffer_content && vmf->pgoff - FIRST_CHUNK_PAGE_OFFSET < buffer_chunks_count)
+    {
+        // chunks that haven't been allocated yet (beyond the data buffer tail) cannot be accessed
+        page_address = channel->buffer_content->chunks[vmf->pgoff - FIRST_CHUNK_PAGE_OFFSET];
+    }
+
+    // the page reference keeps the chunk alive until unmapped, even if released meanwhile (module reset)
+    if (page_address)
+    {
+        struct page* page = virt_to_page(page_address);
+
+        get_page(page);
+        vmf->page = page;
+        result = 0;
+    }
+
+    spin_unlock(&channel->chunks_lock);
+
+    return result;
+}
+
+// the VMA got duplicated (fork) or split, the copy refers to the same address space
+static void data_buffer_vm_open(struct vm_area_struct* vma)
+{
+    struct data_buffer_mapping* const mapping = vma->vm_private_data;
+
+    mutex_lock(&mapping->channel->mappings_mutex);
+    ++mapping->vmas_count;
+    mutex_unlock(&mapping->channel->mappings_mutex);
+}
+
+// the address space is no longer tracked once its last VMA is gone
+static void data_buffer_vm_close(struct vm_area_struct* vma)
+{
+    struct data_buffer_mapping* const mapping = vma->vm_private_data;
+    struct ioctl_string_ops_channel* const channel = mapping->channel;
+
+    mutex_lock(&channel->mappings_mutex);
+
+    if (--mapping->vmas_count == 0)
+    {
+        list_del(&mapping->node);
+        kfree(mapping);
+    }
+
+    mutex_unlock(&channel->mappings_mutex);
+}
+
+static const struct vm_operations_struct data_buffer_vm_ops = {
+    .open = data_buffer_vm_open, .close = data_buffer_vm_close, .fault = data_buffer_vm_fault};
+
+/* Returns the tracked address space the new VMA belongs to (its VMAs count already incremented), ERR_PTR(-EBUSY) if
+   compression is enabled (see enable_compression()) or ERR_PTR(-ENOMEM) if out of memory.
 */
-static uint8_t settings = DEFAULT_SETTINGS;
+static struct data_buffer_mapping* add_data_buffer_mapping(struct ioctl_string_ops_channel* channel,
+                                                           struct address_space* address_space)
+{
+    struct data_buffer_mapping* mapping;
+    struct data_buffer_mapping* added_mapping = NULL;
+
+    mutex_lock(&channel->mappings_mutex);
+
+    if (READ_ONCE(channel->compression_chunks_count) > 0)
+    {
+        mutex_unlock(&channel->mappings_mutex);
+        return ERR_PTR(-EBUSY);
+    }
 
-extern void trim_and_copy_string(char* dest, const char* src, size_t max_str_length, const char* calling_module_name);
+    list_for_each_entry(mapping, &channel->mappings, node)
+    {
+        if (mapping->address_space == address_space)
+        {
+            added_mapping = mapping;
+            break;
+        }
+    }
 
-/***** HELPER FUNCTIONS *****/
+    if (!added_mapping)
+    {
+        added_mapping = kzalloc(sizeof(struct data_buffer_mapping), GFP_KERNEL);
+
+        if (added_mapping)
+        {
+            added_mapping->channel = channel;
+            added_mapping->address_space = address_space;
+            list_add(&added_mapping->node, &channel->mappings);
+        }
+    }
+
+    if (added_mapping)
+    {
+        ++added_mapping->vmas_count;
+    }
+
+    mutex_unlock(&channel->mappings_mutex);
+
+    return added_mapping ? added_mapping : ERR_PTR(-ENOMEM);
+}
 
-static void reset_max_output_size(void)
+/* The data mutex cannot be acquired here (the mmap lock is held, while the data mutex holders might fault on user
+   memory), so concurrent mmap() calls race for installing the header. The offsets published here might get overwritten
+   by a concurrent write, which publishes its own (up to date) offsets anyway.
+*/
+static bool allocate_buffer_header(struct ioctl_string_ops_channel* channel)
 {
-    max_output_size = 0;
-    chars_left_to_read_count = strlen(buffer);
+    if (!READ_ONCE(channel->buffer_header))
+    {
+        struct data_buffer_header* const header = (struct data_buffer_header*)get_zeroed_page(GFP_KERNEL);
+
+        if (header && cmpxchg(&channel->buffer_header, NULL, header) != NULL)
+        {
+            free_page((unsigned long)header);
+        }
+
+        publish_buffer_offsets(channel);
+    }
+
+    return READ_ONCE(channel->buffer_header) != NULL;
 }
 
-static char* compute_data_buffer_current_read_address(void)
+int device_mmap_impl(struct file* filp, struct vm_area_struct* vma)
 {
-    const size_t buffer_length = strlen(buffer);
-    char* buffer_ptr = buffer;
+    struct ioctl_string_ops_channel* const channel = get_file_channel(filp);
+    int result = -EINVAL;
 
-    if (max_output_size > 0)
+    do
     {
-        if (chars_left_to_read_count == 0 || chars_left_to_read_count > buffer_length)
+        const size_t mappable_pages_count = FIRST_CHUNK_PAGE_OFFSET + buffer_chunks_count;
+
+        if (vma->vm_pgoff + vma_pages(vma) > mappable_pages_count)
         {
-            reset_max_output_size();
-            pr_err("%s: invalid chars left to read count, should have been positive and not exceed buffer length",
-                   THIS_MODULE->name);
+            pr_err("%s: cannot map more than %lu pages!\n", THIS_MODULE->name, mappable_pages_count);
+            break;
+        }
+
+        // user space is only allowed to peek at the data buffer, any write should go through the device file
+        if (vma->vm_flags & VM_WRITE)
+        {
+            pr_err("%s: the data buffer can only be mapped read-only!\n", THIS_MODULE->name);
+            result = -EACCES;
+            break;
+        }
+
+        if (!allocate_buffer_header(channel))
+        {
+            pr_err("%s: cannot allocate the data buffer header!\n", THIS_MODULE->name);
+            result = -ENOMEM;
+            break;
+        }
+
+        // released by the close callback of the VMA (called even if mapping fails after this point)
+        struct data_buffer_mapping* const mapping = add_data_buffer_mapping(channel, filp->f_mapping);
+
+        if (IS_ERR(mapping))
+        {
+            pr_err("%s: cannot map the data buffer (%s)!\n", THIS_MODULE->name,
+                   PTR_ERR(mapping) == -EBUSY ? "compression enabled" : "out of memory");
+            result = PTR_ERR(mapping);
+            break;
         }
 
-        const size_t index = buffer_length - chars_left_to_read_count;
-        buffer_ptr += index;
+        vm_flags_clear(vma, VM_MAYWRITE);
+        vm_flags_set(vma, VM_DONTEXPAND | VM_DONTDUMP);
+        vma->vm_ops = &data_buffer_vm_ops;
+        vma->vm_private_data = mapping;
+        result = 0;
+    } while (false);
+
+    return result;
+}
+
+/***** IOCTL FUNCTIONS *****/
+
+long ioctl_do_module_reset(struct ioctl_string_ops_channel* channel)
+{
+    reset_channel_data(channel);
+    return 0;
+}
+
+long ioctl_is_module_reset(struct ioctl_string_ops_channel* channel, bool* is_module_reset)
+{
+    long result = -1;
+
+    if (is_module_reset)
+    {
+        const bool is_reset = (channel->settings == DEFAULT_SETTINGS && channel->buffer_length == 0);
+        const size_t bytes_not_copied_count = copy_to_user(is_module_reset, &is_reset, sizeof(is_reset));
+
+        if (bytes_not_copied_count == 0)
+        {
+            result = 0;
+        }
+        else
+        {
+            pr_err("%s: IOCTL: failed checking if the module is reset!\n", THIS_MODULE->name);
+        }
     }
 
-    return buffer_ptr;
+    return result;
 }
 
-// consolidates output prefix and chars to be read from data buffer in the current read operation
-// the resulting buffer should be freed manually once no longer needed
-char* create_consolidated_buffer(const char* buffer_ptr)
+long ioctl_enable_user_input_trimming(struct ioctl_string_ops_channel* channel, const bool* should_trim)
 {
-    char* consolidated_buffer_ptr = NULL;
+    long result = -1;
 
-    if (buffer_ptr)
+    do
     {
-        const size_t buffer_size = strlen(buffer_ptr);
-        const size_t output_prefix_size = strlen(output_prefix);
-        const size_t consolidated_size = buffer_size + output_prefix_size + 1; // + terminating '\0'
+        if (!should_trim)
+        {
+            break;
+        }
+
+        bool should_trim_user_input;
+        const size_t bytes_not_copied_count = copy_from_user(&should_trim_user_input, should_trim, sizeof(bool));
 
-        consolidated_buffer_ptr = kzalloc(consolidated_size, GFP_KERNEL);
+        if (bytes_not_copied_count > 0)
+        {
+            pr_err("%s: IOCTL: failed updating the \"should trim user input\" setting!\n", THIS_MODULE->name);
+            break;
+        }
 
-        if (consolidated_buffer_ptr)
+        if (should_trim_user_input)
+        {
+            channel->settings |= TRIM_USER_INPUT_ENABLED;
+        }
+        else
         {
-            memset(consolidated_buffer_ptr, '\0', consolidated_size);
+            channel->settings &= ~TRIM_USER_INPUT_ENABLED;
+        }
+
+        result = 0;
+    } while (false);
+
+    return result;
+}
+
+long ioctl_is_user_input_trimming_enabled(struct ioctl_string_ops_channel* channel, bool* is_trimming_enabled)
+{
+    long result = -1;
+
+    if (is_trimming_enabled)
+    {
+        const bool is_enabled = (bool)(channel->settings & TRIM_USER_INPUT_ENABLED);
+        const size_t bytes_not_copied_count = copy_to_user(is_trimming_enabled, &is_enabled, sizeof(is_enabled));
 
-            strncpy(consolidated_buffer_ptr, output_prefix, output_prefix_size);
-            strncpy(consolidated_buffer_ptr + output_prefix_size, buffer_ptr, buffer_size);
+        if (bytes_not_copied_count == 0)
+        {
+            result = 0;
         }
         else
         {
-            pr_err("%s: unable to allocate memory for consolidated output buffer!\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed checking if the user input trimming is enabled!\n", THIS_MODULE->name);
         }
     }
 
-    return consolidated_buffer_ptr;
+    return result;
 }
 
-static void write_to_input_buffer(char* raw_input_buffer)
+long ioctl_get_buffer_size(struct ioctl_string_ops_channel* channel, size_t* buffer_size)
 {
-    if (raw_input_buffer)
+    long result = -1;
+
+    if (buffer_size)
     {
-        if (settings & TRIM_USER_INPUT_ENABLED)
+        const size_t bytes_not_copied_count =
+            copy_to_user(buffer_size, &channel->buffer_length, sizeof(channel->buffer_length));
+
+        if (bytes_not_copied_count == 0)
         {
-            trim_and_copy_string(input_buffer, raw_input_buffer, BUFFER_SIZE, THIS_MODULE->name);
-            pr_info("%s: after trimming the user provided string was stored as: \"%s\"\n", THIS_MODULE->name,
-                    input_buffer);
+            result = 0;
         }
         else
         {
-            const size_t chars_count = strlen(raw_input_buffer);
+            pr_err("%s: IOCTL: failed reading chars count from buffer!\n", THIS_MODULE->name);
+        }
+    }
 
-            if (chars_count < BUFFER_SIZE)
-            {
-                memset(input_buffer, '\0', BUFFER_SIZE);
-                strncpy(input_buffer, raw_input_buffer, chars_count);
-                pr_info("%s: no trimming applied, the user provided string was stored as: \"%s\"\n", THIS_MODULE->name,
-                        input_buffer);
-            }
-            else
-            {
-                // defensive programming
-                pr_err("%s: not enough space in input buffer to copy from raw input buffer!", THIS_MODULE->name);
-            }
+    return result;
+}
+
+long ioctl_set_output_prefix(struct ioctl_string_ops_channel* channel, const void* output_prefix_data)
+{
+    bool success = false;
+
+    do
+    {
+        if (!output_prefix_data)
+        {
+            break;
+        }
+
+        size_t prefix_size;
+        const size_t bytes_not_copied_count = copy_from_user(&prefix_size, output_prefix_data, sizeof(prefix_size));
+
+        if (bytes_not_copied_count > 0)
+        {
+            break;
+        }
+
+        output_prefix_data = (char*)output_prefix_data + sizeof(prefix_size);
+
+        struct output_prefix* new_output_prefix;
+
+        if (!copy_output_prefix_from_user(&new_output_prefix, output_prefix_data, prefix_size))
+        {
+            break;
+        }
+
+        replace_output_prefix(channel, new_output_prefix, prefix_size);
+        notify_readers(channel); // the output length changed
+        success = true;
+    } while (false);
+
+    if (!success)
+    {
+        pr_err("%s: IOCTL: failed setting the output prefix!\n", THIS_MODULE->name);
+    }
+
+    return success ? 0 : -1;
+}
+
+long ioctl_get_output_prefix_size(struct ioctl_string_ops_channel* channel, size_t* output_prefix_size)
+{
+    long result = -1;
+
+    if (output_prefix_size)
+    {
+        const size_t bytes_not_copied_count =
+            copy_to_user(output_prefix_size, &channel->output_prefix_length, sizeof(channel->output_prefix_length));
+
+        if (bytes_not_copied_count == 0)
+        {
+            result = 0;
+        }
+        else
+        {
+            pr_err("%s: IOCTL: failed reading output prefix size!\n", THIS_MODULE->name);
         }
     }
+
+    return result;
 }
 
-static void write_to_data_buffer(void)
+long ioctl_enable_input_append_mode(struct ioctl_string_ops_channel* channel, const bool* should_append)
 {
-    const size_t chars_count = strlen(input_buffer);
+    long result = -1;
 
-    if (settings & USER_INPUT_APPENDING_ENABLED)
+    do
     {
-        const size_t used_chars_count = strlen(buffer);
-        const size_t available_chars_count =
-            BUFFER_SIZE - 1 - used_chars_count; // last char position in buffer reserved for terminating '\0'
+        if (!should_append)
+        {
+            break;
+        }
+
+        bool should_append_user_input;
+        const size_t bytes_not_copied_count = copy_from_user(&should_append_user_input, should_append, sizeof(bool));
+
+        if (bytes_not_copied_count > 0)
+        {
+            pr_err("%s: IOCTL: failed updating the \"input mode\" setting!\n", THIS_MODULE->name);
+            break;
+        }
 
-        // limit the number of chars to append to the available space
-        const size_t chars_to_append_count = chars_count < available_chars_count ? chars_count : available_chars_count;
+        if (should_append_user_input)
+        {
+            channel->settings |= USER_INPUT_APPENDING_ENABLED;
+        }
+        else
+        {
+            channel->settings &= ~USER_INPUT_APPENDING_ENABLED;
+        }
+
+        result = 0;
+    } while (false);
+
+    return result;
+}
 
-        strncpy(buffer + used_chars_count, input_buffer, chars_to_append_count);
+long ioctl_is_input_append_mode_enabled(struct ioctl_string_ops_channel* channel, bool* is_append_enabled)
+{
+    long result = -1;
+
+    if (is_append_enabled)
+    {
+        const bool is_enabled = (bool)(channel->settings & USER_INPUT_APPENDING_ENABLED);
+        const size_t bytes_not_copied_count = copy_to_user(is_append_enabled, &is_enabled, sizeof(is_enabled));
 
-        if (chars_to_append_count < chars_count)
+        if (bytes_not_copied_count == 0)
         {
-            pr_warn("%s: not all input could be appended to the driver buffer. There is not enough space. %lu "
-                    "characters got appended out of %lu.\n",
-                    THIS_MODULE->name, chars_to_append_count, chars_count);
+            result = 0;
         }
         else
         {
-            pr_info("%s: the input has been appended to the driver buffer\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed checking if the user input append mode is enabled!\n", THIS_MODULE->name);
         }
     }
-    else
+
+    return result;
+}
+
+long ioctl_enable_wait_for_data(struct ioctl_string_ops_channel* channel, const bool* should_wait)
+{
+    long result = -1;
+
+    do
+    {
+        if (!should_wait)
+        {
+            break;
+        }
+
+        bool should_wait_for_data;
+        const size_t bytes_not_copied_count = copy_from_user(&should_wait_for_data, should_wait, sizeof(bool));
+
+        if (bytes_not_copied_count > 0)
+        {
+            pr_err("%s: IOCTL: failed updating the \"wait for data\" setting!\n", THIS_MODULE->name);
+            break;
+        }
+
+        // when disabling, the waiting readers get the current content
+        update_settings(channel, should_wait_for_data ? channel->settings | WAIT_FOR_DATA_ENABLED
+                                                      : channel->settings & ~WAIT_FOR_DATA_ENABLED);
+
+        result = 0;
+    } while (false);
+
+    return result;
+}
+
+long ioctl_is_wait_for_data_enabled(struct ioctl_string_ops_channel* channel, bool* is_wait_enabled)
+{
+    long result = -1;
+
+    if (is_wait_enabled)
     {
-        memset(buffer, '\0', BUFFER_SIZE);
-        strncpy(buffer, input_buffer, chars_count);
+        const bool is_enabled = (bool)(channel->settings & WAIT_FOR_DATA_ENABLED);
+        const size_t bytes_not_copied_count = copy_to_user(is_wait_enabled, &is_enabled, sizeof(is_enabled));
+
+        if (bytes_not_copied_count == 0)
+        {
+            result = 0;
+        }
+        else
+        {
+            pr_err("%s: IOCTL: failed checking if waiting for data is enabled!\n", THIS_MODULE->name);
+        }
     }
 
-    reset_max_output_size();
+    return result;
 }
 
-/***** READ/WRITE IMPLEMENTATION FUNCTIONS *****/
+long ioctl_enable_streaming_mode(struct ioctl_string_ops_channel* channel, const bool* should_stream)
+{
+    long result = -1;
+
+    do
+    {
+        if (!should_stream)
+        {
+            break;
+        }
 
-ssize_t device_read_impl(struct file* filp, char* buf, size_t length, loff_t* offset)
-{
-    const bool is_output_prefix_required = strlen(output_prefix) > 0;
+        bool should_enable_streaming;
+        const size_t bytes_not_copied_count = copy_from_user(&should_enable_streaming, should_stream, sizeof(bool));
 
-    char* buffer_ptr = compute_data_buffer_current_read_address();
-    char* consolidated_buffer_ptr = is_output_prefix_required ? create_consolidated_buffer(buffer_ptr) : NULL;
-    char* current_buffer_ptr = is_output_prefix_required ? consolidated_buffer_ptr : buffer_ptr;
+        if (bytes_not_copied_count > 0)
+        {
+            pr_err("%s: IOCTL: failed updating the \"streaming mode\" setting!\n", THIS_MODULE->name);
+            break;
+        }
 
-    ssize_t read_bytes_count = 0;
+        if (should_enable_streaming && is_record_mode_enabled(channel))
+        {
+            pr_err("%s: IOCTL: the streaming mode cannot be enabled while in record mode!\n", THIS_MODULE->name);
+            break;
+        }
 
-    if (current_buffer_ptr)
-    {
-        const size_t output_prefix_size = strlen(output_prefix);
-        size_t bytes_to_read_count =
-            max_output_size > 0 ? max_output_size + output_prefix_size : strlen(current_buffer_ptr);
+        const uint8_t new_settings =
+            should_enable_streaming ? channel->settings | STREAMING_MODE_ENABLED
+                                    : channel->settings & ~STREAMING_MODE_ENABLED;
 
-        while (bytes_to_read_count && *current_buffer_ptr)
+        if (allocate_queues(channel, new_settings) < 0)
         {
-            put_user(*(current_buffer_ptr++), buf++);
-            ++read_bytes_count;
-            --bytes_to_read_count;
+            result = -ENOMEM;
+            break;
         }
 
-        // defensive programming, read_bytes_count should never be lower than output_prefix_size
-        const size_t read_non_prefix_chars_count =
-            read_bytes_count > output_prefix_size ? read_bytes_count - output_prefix_size : 0;
+        // the stream starts empty each time the mode gets enabled, the data buffer content is kept meanwhile
+        update_settings(channel, new_settings);
 
-        // same here
-        chars_left_to_read_count = read_non_prefix_chars_count < chars_left_to_read_count
-                                       ? chars_left_to_read_count - read_non_prefix_chars_count
-                                       : 0;
-    }
-    else
-    {
-        read_bytes_count = -ENOMEM;
-    }
+        result = 0;
+    } while (false);
 
-    if (read_bytes_count > 0)
-    {
-        pr_info("%s: user read: %s", THIS_MODULE->name, buffer);
-    }
+    return result;
+}
 
-    if (chars_left_to_read_count == 0)
-    {
-        // maximum output size to be reset to the buffer length (0 - read whole content)
-        reset_max_output_size();
-    }
+long ioctl_is_streaming_mode_enabled(struct ioctl_string_ops_channel* channel, bool* is_streaming_enabled)
+{
+    long result = -1;
 
-    if (consolidated_buffer_ptr)
+    if (is_streaming_enabled)
     {
-        kfree(consolidated_buffer_ptr);
+        const bool is_enabled = is_streaming_mode_enabled(channel);
+        const size_t bytes_not_copied_count = copy_to_user(is_streaming_enabled, &is_enabled, sizeof(is_enabled));
+
+        if (bytes_not_copied_count == 0)
+        {
+            result = 0;
+        }
+        else
+        {
+            pr_err("%s: IOCTL: failed checking if the streaming mode is enabled!\n", THIS_MODULE->name);
+        }
     }
 
-    return read_bytes_count;
+    return result;
 }
 
-ssize_t device_write_impl(struct file* filp, const char* buf, size_t length, loff_t* offset)
+long ioctl_enable_record_mode(struct ioctl_string_ops_channel* channel, const bool* should_queue_records)
 {
-    ssize_t result = -EINVAL;
+    long result = -1;
 
     do
     {
-        char* raw_input_buffer = kzalloc(BUFFER_SIZE, GFP_KERNEL);
-
-        if (!raw_input_buffer)
+        if (!should_queue_records)
         {
-            pr_err("%s: device_write_impl: memory could not be allocated!\n", THIS_MODULE->name);
-            result = -ENOMEM;
             break;
         }
 
-        memset(raw_input_buffer, '\0', BUFFER_SIZE);
-
-        const size_t max_bytes_to_copy_count = BUFFER_SIZE - 1;
-
-        // bytes count to copy into raw input buffer are capped no matter the subsequent operation (trim, append, etc)
-        const size_t bytes_to_copy_count = length > max_bytes_to_copy_count ? max_bytes_to_copy_count : length;
-        const size_t bytes_not_copied_count = copy_from_user(raw_input_buffer, buf, bytes_to_copy_count);
+        bool should_enable_records;
+        const size_t bytes_not_copied_count =
+            copy_from_user(&should_enable_records, should_queue_records, sizeof(bool));
 
         if (bytes_not_copied_count > 0)
         {
-            pr_warn("%s: %ld bytes could not be copied from user\n", THIS_MODULE->name, bytes_not_copied_count);
+            pr_err("%s: IOCTL: failed updating the \"record mode\" setting!\n", THIS_MODULE->name);
+            break;
+        }
+
+        if (should_enable_records && is_streaming_mode_enabled(channel))
+        {
+            pr_err("%s: IOCTL: the record mode cannot be enabled while in streaming mode!\n", THIS_MODULE->name);
+            break;
         }
 
-        pr_info("%s: user wrote: %s\n", THIS_MODULE->name, raw_input_buffer);
+        const uint8_t new_settings =
+            should_enable_records ? channel->settings | RECORD_MODE_ENABLED : channel->settings & ~RECORD_MODE_ENABLED;
 
-        write_to_input_buffer(raw_input_buffer);
-        write_to_data_buffer();
+        if (allocate_queues(channel, new_settings) < 0)
+        {
+            result = -ENOMEM;
+            break;
+        }
 
-        result = (ssize_t)strlen(
-            raw_input_buffer); // the total number of chars provided by user (not the trimmed one) needs to be returned
+        // the record queue starts empty each time the mode gets enabled, the data buffer content is kept meanwhile
+        update_settings(channel, new_settings);
 
-        kfree(raw_input_buffer);
+        result = 0;
     } while (false);
 
     return result;
 }
 
-/***** IOCTL FUNCTIONS *****/
-
-long ioctl_do_module_reset()
-{
-    reset_module_data();
-    return 0;
-}
-
-long ioctl_is_module_reset(bool* is_module_reset)
+long ioctl_is_record_mode_enabled(struct ioctl_string_ops_channel* channel, bool* is_records_enabled)
 {
     long result = -1;
 
-    if (is_module_reset)
+    if (is_records_enabled)
     {
-        const bool is_reset = (settings == DEFAULT_SETTINGS && strlen(buffer) == 0);
-        const size_t bytes_not_copied_count = copy_to_user(is_module_reset, &is_reset, sizeof(is_reset));
+        const bool is_enabled = is_record_mode_enabled(channel);
+        const size_t bytes_not_copied_count = copy_to_user(is_records_enabled, &is_enabled, sizeof(is_enabled));
 
         if (bytes_not_copied_count == 0)
         {
@@ -273,78 +2829,149 @@ long ioctl_is_module_reset(bool* is_module_reset)
         }
         else
         {
-            pr_err("%s: IOCTL: failed checking if the module is reset!\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed checking if the record mode is enabled!\n", THIS_MODULE->name);
         }
     }
 
     return result;
 }
 
-long ioctl_enable_user_input_trimming(const bool* should_trim)
+// the records are copied in one go (no intermediate buffer), the lengths being interleaved with them
+long ioctl_dequeue_records(struct ioctl_string_ops_channel* channel, struct ioctl_string_ops_records* records)
 {
     long result = -1;
 
     do
     {
-        if (!should_trim)
+        if (!records || !is_record_mode_enabled(channel))
         {
             break;
         }
 
-        bool should_trim_user_input;
-        const size_t bytes_not_copied_count = copy_from_user(&should_trim_user_input, should_trim, sizeof(bool));
+        struct ioctl_string_ops_records request;
 
-        if (bytes_not_copied_count > 0)
+        if (copy_from_user(&request, records, sizeof(request)) > 0)
         {
-            pr_err("%s: IOCTL: failed updating the \"should trim user input\" setting!\n", THIS_MODULE->name);
             break;
         }
 
-        if (should_trim_user_input)
+        struct iov_iter to;
+
+        if (import_ubuf(ITER_DEST, request.buffer, request.buffer_size, &to) < 0)
         {
-            settings |= TRIM_USER_INPUT_ENABLED;
+            break;
         }
-        else
+
+        if (mutex_lock_interruptible(&channel->stream_read_mutex))
+        {
+            result = -ERESTARTSYS;
+            break;
+        }
+
+        // the channel might have been reset meanwhile by another file
+        if (!is_record_queue_usable(channel))
+        {
+            mutex_unlock(&channel->stream_read_mutex);
+            result = -EIO;
+            break;
+        }
+
+        bool is_copy_failed = false;
+        request.records_count = 0;
+
+        while (request.records_count < request.max_records_count && !kfifo_is_empty(&channel->record_queue))
+        {
+            const size_t record_size = kfifo_peek_len(&channel->record_queue);
+            const u16 record_length = (u16)record_size; // stored on 2 bytes (see MAX_RECORD_SIZE)
+
+            if (sizeof(record_length) + record_size > iov_iter_count(&to))
+            {
+                break;
+            }
+
+            is_copy_failed = copy_to_iter(&record_length, sizeof(record_length), &to) < sizeof(record_length) ||
+                             dequeue_record(channel, &to) < 0;
+
+            if (is_copy_failed)
+            {
+                break;
+            }
+
+            ++request.records_count;
+        }
+
+        mutex_unlock(&channel->stream_read_mutex);
+
+        request.bytes_count = request.buffer_size - iov_iter_count(&to);
+
+        if (is_copy_failed || copy_to_user(records, &request, sizeof(request)) > 0)
         {
-            settings &= ~TRIM_USER_INPUT_ENABLED;
+            result = -EFAULT;
+            break;
         }
 
+        hot_path_info("%s: IOCTL: dequeued %zu records\n", THIS_MODULE->name, request.records_count);
         result = 0;
     } while (false);
 
+    if (result == -1)
+    {
+        pr_err("%s: IOCTL: failed dequeuing the records!\n", THIS_MODULE->name);
+    }
+
     return result;
 }
 
-long ioctl_is_user_input_trimming_enabled(bool* is_trimming_enabled)
+long ioctl_set_max_output_size(struct ioctl_string_ops_channel* channel, size_t* value)
 {
     long result = -1;
 
-    if (is_trimming_enabled)
+    do
     {
-        const bool is_enabled = (bool)(settings & TRIM_USER_INPUT_ENABLED);
-        const size_t bytes_not_copied_count = copy_to_user(is_trimming_enabled, &is_enabled, sizeof(is_enabled));
+        if (!value)
+        {
+            break;
+        }
 
-        if (bytes_not_copied_count == 0)
+        size_t max_chars_to_read_count;
+        size_t bytes_not_copied_count =
+            copy_from_user(&max_chars_to_read_count, value, sizeof(max_chars_to_read_count));
+
+        if (bytes_not_copied_count > 0)
         {
-            result = 0;
+            pr_err("%s: IOCTL: failed updating the \"max output size\"!\n", THIS_MODULE->name);
+            break;
         }
-        else
+
+        size_t remaining_chars_count;
+        compute_max_output_size(channel, &max_chars_to_read_count, &remaining_chars_count);
+
+        bytes_not_copied_count = copy_to_user(value, &remaining_chars_count, sizeof(remaining_chars_count));
+
+        if (bytes_not_copied_count > 0)
         {
-            pr_err("%s: IOCTL: failed checking if the user input trimming is enabled!\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed returning the \"chars left to read count\"!\n", THIS_MODULE->name);
+            break;
         }
-    }
+
+        channel->max_output_size = max_chars_to_read_count;
+        channel->chars_left_to_read_count = remaining_chars_count;
+        publish_buffer_offsets(channel);
+        notify_readers(channel); // reading the windows of the data buffer doesn't involve waiting
+        result = 0;
+    } while (false);
 
     return result;
 }
 
-long ioctl_get_buffer_size(size_t* buffer_size)
+long ioctl_get_max_output_size(struct ioctl_string_ops_channel* channel, size_t* max_output_length)
 {
     long result = -1;
 
-    if (buffer_size)
+    if (max_output_length)
     {
-        const size_t buffer_length = strlen(buffer);
-        const size_t bytes_not_copied_count = copy_to_user(buffer_size, &buffer_length, sizeof(buffer_length));
+        const size_t bytes_not_copied_count =
+            copy_to_user(max_output_length, &channel->max_output_size, sizeof(channel->max_output_size));
 
         if (bytes_not_copied_count == 0)
         {
@@ -352,73 +2979,97 @@ long ioctl_get_buffer_size(size_t* buffer_size)
         }
         else
         {
-            pr_err("%s: IOCTL: failed reading chars count from buffer!\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed reading max output size!\n", THIS_MODULE->name);
         }
     }
 
     return result;
 }
 
-long ioctl_set_output_prefix(const void* output_prefix_data)
+long ioctl_set_config(struct ioctl_string_ops_channel* channel, const struct ioctl_string_ops_config* config)
 {
     bool success = false;
 
     do
     {
-        if (!output_prefix_data)
+        if (!config)
         {
             break;
         }
 
-        size_t prefix_size;
-        size_t bytes_not_copied_count = copy_from_user(&prefix_size, output_prefix_data, sizeof(prefix_size));
+        struct ioctl_string_ops_config new_config;
+        const size_t bytes_not_copied_count = copy_from_user(&new_config, config, sizeof(new_config));
 
-        if (bytes_not_copied_count > 0 || prefix_size >= PREFIX_BUFFER_SIZE)
+        if (bytes_not_copied_count > 0)
         {
             break;
         }
 
-        if (prefix_size == 0)
+        if (new_config.version != IOCTL_STRING_OPS_CONFIG_VERSION)
         {
-            memset(output_prefix, '\0', PREFIX_BUFFER_SIZE);
-            success = true;
+            pr_err("%s: IOCTL: unsupported config version: %u\n", THIS_MODULE->name, new_config.version);
             break;
         }
 
-        output_prefix_data = (char*)output_prefix_data + sizeof(prefix_size);
+        if (new_config.settings & ~SUPPORTED_SETTINGS)
+        {
+            pr_err("%s: IOCTL: unsupported settings requested: %u\n", THIS_MODULE->name, new_config.settings);
+            break;
+        }
+
+        if ((new_config.settings & QUEUE_MODES) == QUEUE_MODES)
+        {
+            pr_err("%s: IOCTL: streaming and record mode cannot be enabled together\n", THIS_MODULE->name);
+            break;
+        }
 
-        char temp[PREFIX_BUFFER_SIZE];
+        struct output_prefix* new_output_prefix;
 
-        memset(temp, '\0', PREFIX_BUFFER_SIZE);
-        bytes_not_copied_count = copy_from_user(temp, output_prefix_data, prefix_size);
+        if (!copy_output_prefix_from_user(&new_output_prefix, new_config.output_prefix, new_config.output_prefix_size))
+        {
+            break;
+        }
 
-        if (bytes_not_copied_count > 0 || strlen(temp) != prefix_size)
+        // last step that might fail, nothing gets allocated if the config is rejected
+        if (allocate_queues(channel, (uint8_t)new_config.settings) < 0)
         {
+            kfree(new_output_prefix);
             break;
         }
 
-        memset(output_prefix, '\0', PREFIX_BUFFER_SIZE);
-        strncpy(output_prefix, temp, prefix_size);
+        // all config items have been validated, the new config can be applied as a whole
+        update_settings(channel, (uint8_t)new_config.settings);
+        replace_output_prefix(channel, new_output_prefix, new_config.output_prefix_size);
+        compute_max_output_size(channel, &new_config.max_output_size, &channel->chars_left_to_read_count);
+        channel->max_output_size = new_config.max_output_size;
+        publish_buffer_offsets(channel);
+
         success = true;
     } while (false);
 
     if (!success)
     {
-        pr_err("%s: IOCTL: failed setting the output prefix!\n", THIS_MODULE->name);
+        pr_err("%s: IOCTL: failed applying the config!\n", THIS_MODULE->name);
     }
 
     return success ? 0 : -1;
 }
 
-long ioctl_get_output_prefix_size(size_t* output_prefix_size)
+long ioctl_get_state(struct ioctl_string_ops_channel* channel, struct ioctl_string_ops_state* state)
 {
     long result = -1;
 
-    if (output_prefix_size)
+    if (state)
     {
-        const size_t module_output_prefix_length = strlen(output_prefix);
-        const size_t bytes_not_copied_count =
-            copy_to_user(output_prefix_size, &module_output_prefix_length, sizeof(module_output_prefix_length));
+        const struct ioctl_string_ops_state current_state = {
+            .version = IOCTL_STRING_OPS_CONFIG_VERSION,
+            .settings = channel->settings,
+            .buffer_size = channel->buffer_length,
+            .output_prefix_size = channel->output_prefix_length,
+            .max_output_size = channel->max_output_size,
+            .chars_left_to_read_count = channel->chars_left_to_read_count};
+
+        const size_t bytes_not_copied_count = copy_to_user(state, &current_state, sizeof(current_state));
 
         if (bytes_not_copied_count == 0)
         {
@@ -426,40 +3077,80 @@ long ioctl_get_output_prefix_size(size_t* output_prefix_size)
         }
         else
         {
-            pr_err("%s: IOCTL: failed reading output prefix size!\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed reading the module state!\n", THIS_MODULE->name);
         }
     }
 
     return result;
 }
 
-long ioctl_enable_input_append_mode(const bool* should_append)
+long ioctl_set_compression(struct ioctl_string_ops_channel* channel,
+                           const struct ioctl_string_ops_compression* compression)
 {
     long result = -1;
 
     do
     {
-        if (!should_append)
+        if (!compression)
         {
             break;
         }
 
-        bool should_append_user_input;
-        const size_t bytes_not_copied_count = copy_from_user(&should_append_user_input, should_append, sizeof(bool));
+        struct ioctl_string_ops_compression new_compression;
+        const size_t bytes_not_copied_count = copy_from_user(&new_compression, compression, sizeof(new_compression));
 
         if (bytes_not_copied_count > 0)
         {
-            pr_err("%s: IOCTL: failed updating the \"input mode\" setting!\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed updating the compression mode!\n", THIS_MODULE->name);
             break;
         }
 
-        if (should_append_user_input)
+        if (new_compression.mode != COMPRESSION_MODE_NONE && new_compression.mode != COMPRESSION_MODE_LZ4)
         {
-            settings |= USER_INPUT_APPENDING_ENABLED;
+            pr_err("%s: IOCTL: unsupported compression mode: %u\n", THIS_MODULE->name, new_compression.mode);
+            break;
         }
-        else
+
+        const bool should_compress = new_compression.mode == COMPRESSION_MODE_LZ4;
+        const size_t new_chunks_count = should_compress ? new_compression.chunk_size / BUFFER_CHUNK_SIZE : 0;
+
+        if (should_compress && (new_compression.chunk_size % BUFFER_CHUNK_SIZE != 0 || new_chunks_count == 0 ||
+                                new_chunks_count > MAX_COMPRESSION_CHUNK_PAGES))
+        {
+            pr_err("%s: IOCTL: invalid compression chunk size: %lu\n", THIS_MODULE->name, new_compression.chunk_size);
+            break;
+        }
+
+        if (new_chunks_count == channel->compression_chunks_count)
+        {
+            result = 0;
+            break;
+        }
+
+        if (restore_compressed_groups(channel) < 0)
+        {
+            pr_err("%s: IOCTL: failed decompressing the data buffer!\n", THIS_MODULE->name);
+            result = -ENOMEM;
+            break;
+        }
+
+        disable_compression(channel);
+
+        // compression remains disabled if enabling fails
+        const int enable_result = new_chunks_count > 0 ? enable_compression(channel, new_chunks_count) : 0;
+
+        if (enable_result == -EBUSY)
         {
-            settings &= ~USER_INPUT_APPENDING_ENABLED;
+            pr_err("%s: IOCTL: cannot enable compression while the data buffer is mapped!\n", THIS_MODULE->name);
+            result = -EBUSY;
+            break;
+        }
+
+        if (enable_result < 0)
+        {
+            pr_err("%s: IOCTL: failed allocating the compression buffers!\n", THIS_MODULE->name);
+            result = -ENOMEM;
+            break;
         }
 
         result = 0;
@@ -468,14 +3159,37 @@ long ioctl_enable_input_append_mode(const bool* should_append)
     return result;
 }
 
-long ioctl_is_input_append_mode_enabled(bool* is_append_enabled)
+long ioctl_get_compression_stats(struct ioctl_string_ops_channel* channel,
+                                 struct ioctl_string_ops_compression_stats* compression_stats)
 {
     long result = -1;
 
-    if (is_append_enabled)
+    if (compression_stats)
     {
-        const bool is_enabled = (bool)(settings & USER_INPUT_APPENDING_ENABLED);
-        const size_t bytes_not_copied_count = copy_to_user(is_append_enabled, &is_enabled, sizeof(is_enabled));
+        struct ioctl_string_ops_compression_stats current_stats = {
+            .mode = channel->compression_chunks_count > 0 ? COMPRESSION_MODE_LZ4 : COMPRESSION_MODE_NONE,
+            .chunk_size = channel->compression_chunks_count * BUFFER_CHUNK_SIZE};
+
+        const struct buffer_content* const content = channel->buffer_content;
+
+        for (size_t group_index = 0; group_index < channel->sealed_groups_count; ++group_index)
+        {
+            const struct compressed_chunks* const group =
+                content->compressed_groups ? content->compressed_groups[group_index] : NULL;
+
+            if (group)
+            {
+                current_stats.compressed_chars_count += current_stats.chunk_size;
+                current_stats.compressed_size += group->size;
+            }
+        }
+
+        current_stats.ratio_percent =
+            current_stats.compressed_size > 0
+                ? (uint32_t)(current_stats.compressed_chars_count * 100 / current_stats.compressed_size)
+                : 0;
+
+        const size_t bytes_not_copied_count = copy_to_user(compression_stats, &current_stats, sizeof(current_stats));
 
         if (bytes_not_copied_count == 0)
         {
@@ -483,92 +3197,169 @@ long ioctl_is_input_append_mode_enabled(bool* is_append_enabled)
         }
         else
         {
-            pr_err("%s: IOCTL: failed checking if the user input append mode is enabled!\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed reading the compression stats!\n", THIS_MODULE->name);
         }
     }
 
     return result;
 }
 
-long ioctl_set_max_output_size(size_t* value)
+long ioctl_set_read_filter(struct file* filp, const struct ioctl_string_ops_read_filter* read_filter)
 {
     long result = -1;
 
     do
     {
-        if (!value)
+        if (!read_filter)
         {
             break;
         }
 
-        size_t max_chars_to_read_count;
-        size_t bytes_not_copied_count =
-            copy_from_user(&max_chars_to_read_count, value, sizeof(max_chars_to_read_count));
+        struct ioctl_string_ops_read_filter new_read_filter;
+        const size_t bytes_not_copied_count = copy_from_user(&new_read_filter, read_filter, sizeof(new_read_filter));
 
         if (bytes_not_copied_count > 0)
         {
-            pr_err("%s: IOCTL: failed updating the \"max output size\"!\n", THIS_MODULE->name);
+            pr_err("%s: IOCTL: failed updating the read filter!\n", THIS_MODULE->name);
             break;
         }
 
-        const size_t buffer_size = strlen(buffer);
-        size_t remaining_chars_count = chars_left_to_read_count;
+        struct read_filter* filter = NULL;
 
-        if (max_chars_to_read_count == 0)
-        {
-            remaining_chars_count = buffer_size; // move reading to the beginning of the buffer
-        }
-        else if (max_chars_to_read_count > remaining_chars_count)
+        if (new_read_filter.type != READ_FILTER_NONE)
         {
-            max_chars_to_read_count =
-                remaining_chars_count; // cap maximum output size to the count of chars that are left to read
+            filter = create_read_filter(&new_read_filter);
+
+            if (!filter)
+            {
+                break;
+            }
         }
 
-        bytes_not_copied_count = copy_to_user(value, &remaining_chars_count, sizeof(remaining_chars_count));
+        struct reader_data* reader = filp->private_data;
 
-        if (bytes_not_copied_count > 0)
+        if (mutex_lock_interruptible(&reader->read_mutex))
         {
-            pr_err("%s: IOCTL: failed returning the \"chars left to read count\"!\n", THIS_MODULE->name);
+            free_read_filter(filter);
+            result = -ERESTARTSYS;
             break;
         }
 
-        max_output_size = max_chars_to_read_count;
-        chars_left_to_read_count = remaining_chars_count;
+        struct read_filter* const old_filter = reader->filter;
+
+        reader->filter = filter;
+        reader->matched_line_position = -1;
+        mutex_unlock(&reader->read_mutex);
+
+        free_read_filter(old_filter);
         result = 0;
     } while (false);
 
     return result;
 }
 
-long ioctl_get_max_output_size(size_t* max_output_length)
+void set_buffer_sizes(size_t max_buffer_size, size_t max_output_prefix_size, size_t stream_buffer_size,
+                      size_t max_record_queue_size)
 {
-    long result = -1;
+    buffer_capacity = max_buffer_size;
+    buffer_chunks_count = DIV_ROUND_UP(max_buffer_size, BUFFER_CHUNK_SIZE);
+    max_prefix_size = max_output_prefix_size;
+    stream_fifo_size = stream_buffer_size;
+    record_queue_size = max_record_queue_size;
+}
 
-    if (max_output_length)
-    {
-        const size_t bytes_not_copied_count =
-            copy_to_user(max_output_length, &max_output_size, sizeof(max_output_size));
+int create_channels(size_t count)
+{
+    int result = 0;
 
-        if (bytes_not_copied_count == 0)
+    channels = kcalloc(count, sizeof(struct ioctl_string_ops_channel), GFP_KERNEL);
+
+    if (channels)
+    {
+        for (size_t index = 0; index < count && result == 0; ++index)
         {
-            result = 0;
+            struct ioctl_string_ops_channel* const channel = &channels[index];
+
+            result = init_srcu_struct(&channel->readers_srcu);
+
+            if (result < 0)
+            {
+                break;
+            }
+
+            channels_count = index + 1; // released by free_module_data() from now on
+
+            spin_lock_init(&channel->chunks_lock);
+            init_waitqueue_head(&channel->data_wait_queue);
+            init_waitqueue_head(&channel->space_wait_queue);
+            mutex_init(&channel->data_mutex);
+            mutex_init(&channel->stream_read_mutex);
+            mutex_init(&channel->stream_write_mutex);
+            mutex_init(&channel->mappings_mutex);
+            INIT_LIST_HEAD(&channel->mappings);
+            seqcount_mutex_init(&channel->content_seqcount, &channel->data_mutex);
+            channel->settings = DEFAULT_SETTINGS;
         }
-        else
+
+        if (result < 0)
         {
-            pr_err("%s: IOCTL: failed reading max output size!\n", THIS_MODULE->name);
+            free_module_data();
         }
     }
+    else
+    {
+        result = -ENOMEM;
+    }
 
     return result;
 }
 
+void free_module_data(void)
+{
+    for (size_t index = 0; index < channels_count; ++index)
+    {
+        struct ioctl_string_ops_channel* const channel = &channels[index];
+
+        // no user left at this point, the data mutex is only required by the content write sections
+        mutex_lock(&channel->data_mutex);
+        free_data_buffer_contents(channel);
+        disable_compression(channel);
+        replace_output_prefix(channel, NULL, 0);
+        mutex_unlock(&channel->data_mutex);
+
+        free_queues(channel);
+
+        if (channel->buffer_header)
+        {
+            free_page((unsigned long)channel->buffer_header);
+            channel->buffer_header = NULL;
+        }
+
+        srcu_barrier(&channel->readers_srcu); // the released content might still be pending
+        cleanup_srcu_struct(&channel->readers_srcu);
+    }
+
+    kfree(channels);
+    channels = NULL;
+    channels_count = 0;
+}
+
 void reset_module_data(void)
 {
-    memset(input_buffer, '\0', BUFFER_SIZE);
-    memset(buffer, '\0', BUFFER_SIZE);
-    memset(output_prefix, '\0', PREFIX_BUFFER_SIZE);
+    for (size_t index = 0; index < channels_count; ++index)
+    {
+        mutex_lock(&channels[index].data_mutex);
+        reset_channel_data(&channels[index]);
+        mutex_unlock(&channels[index].data_mutex);
+    }
+}
 
-    reset_max_output_size();
+int lock_channel_data(struct ioctl_string_ops_channel* channel)
+{
+    return mutex_lock_interruptible(&channel->data_mutex) ? -ERESTARTSYS : 0;
+}
 
-    settings = DEFAULT_SETTINGS;
+void unlock_channel_data(struct ioctl_string_ops_channel* channel)
+{
+    mutex_unlock(&channel->data_mutex);
 }
@@ -1,10 +1,20 @@
 #include <linux/cdev.h>
 #include <linux/fs.h>
+#include <linux/mm.h>
+#include <linux/moduleparam.h>
+#include <linux/poll.h>
 
 #include "ioctl_string_ops_impl.h"
+#include "ioctl_string_ops_stats.h"
+#include "kernel_utilities_log.h"
 
 #define SUCCESS 0
-#define SUPPORTED_MINOR_NUMBERS_COUNT 1
+#define DEFAULT_CHANNELS_COUNT 1
+#define MAX_CHANNELS_COUNT 256
+#define DEFAULT_MAX_BUFFER_SIZE 1023 // same capacity as the former static data buffer (1024 chars including '\0')
+#define DEFAULT_MAX_PREFIX_SIZE 127  // same capacity as the former static prefix buffer (128 chars including '\0')
+#define DEFAULT_STREAM_BUFFER_SIZE PAGE_SIZE
+#define DEFAULT_RECORD_QUEUE_SIZE PAGE_SIZE
 
 // 9999 is an arbitrarily chosen "magic number" (in a "real" (production) system an official assignment would be
 // required; might be the major driver number)
@@ -19,6 +29,18 @@
 #define IOCTL_IS_INPUT_APPEND_MODE_ENABLED _IOR(9999, 'i', bool*)
 #define IOCTL_SET_MAX_OUTPUT_SIZE _IOWR(9999, 'j', size_t*)
 #define IOCTL_GET_MAX_OUTPUT_SIZE _IOR(9999, 'k', size_t*)
+#define IOCTL_SET_CONFIG _IOW(9999, 'l', struct ioctl_string_ops_config*)
+#define IOCTL_GET_STATE _IOR(9999, 'm', struct ioctl_string_ops_state*)
+#define IOCTL_ENABLE_WAIT_FOR_DATA _IOW(9999, 'n', bool*)
+#define IOCTL_IS_WAIT_FOR_DATA_ENABLED _IOR(9999, 'o', bool*)
+#define IOCTL_ENABLE_STREAMING_MODE _IOW(9999, 'p', bool*)
+#define IOCTL_IS_STREAMING_MODE_ENABLED _IOR(9999, 'q', bool*)
+#define IOCTL_ENABLE_RECORD_MODE _IOW(9999, 'r', bool*)
+#define IOCTL_IS_RECORD_MODE_ENABLED _IOR(9999, 's', bool*)
+#define IOCTL_DEQUEUE_RECORDS _IOWR(9999, 't', struct ioctl_string_ops_records*)
+#define IOCTL_SET_COMPRESSION _IOW(9999, 'u', struct ioctl_string_ops_compression*)
+#define IOCTL_GET_COMPRESSION_STATS _IOR(9999, 'v', struct ioctl_string_ops_compression_stats*)
+#define IOCTL_SET_READ_FILTER _IOW(9999, 'w', struct ioctl_string_ops_read_filter*)
 
 MODULE_LICENSE("GPL");
 
@@ -28,27 +50,65 @@ MODULE_DESCRIPTION("This driver module provides and receives strings to/from use
 
 MODULE_AUTHOR("Liviu Popa");
 
+/* PARAMETERS */
+
+// maximum number of chars that can be stored in the data buffer (memory is allocated page by page as content grows)
+static ulong max_buffer_size = DEFAULT_MAX_BUFFER_SIZE;
+
+module_param(max_buffer_size, ulong, S_IRUSR);
+
+// maximum number of chars of the output prefix (memory is allocated when the prefix is set, exact size)
+static ulong max_prefix_size = DEFAULT_MAX_PREFIX_SIZE;
+
+module_param(max_prefix_size, ulong, S_IRUSR);
+
+// capacity of the byte ring used in streaming mode (rounded up to a power of 2, allocated when the mode gets enabled)
+static ulong stream_buffer_size = DEFAULT_STREAM_BUFFER_SIZE;
+
+module_param(stream_buffer_size, ulong, S_IRUSR);
+
+// capacity of the queue used in record mode, record lengths included (rounded up to a power of 2, allocated on demand)
+static ulong record_queue_size = DEFAULT_RECORD_QUEUE_SIZE;
+
+module_param(record_queue_size, ulong, S_IRUSR);
+
+/* number of independent channels, each having its own minor number and device file: ioctlstringops (minor 0),
+   ioctlstringops1, ioctlstringops2, etc.
+*/
+static uint channels_count = DEFAULT_CHANNELS_COUNT;
+
+module_param(channels_count, uint, S_IRUSR);
+
 static struct class* ioctl_string_ops_class = NULL;
 static struct cdev ioctl_string_ops_cdev;
 
 static int major_number = 0;
-static int is_device_open = 0;
 
 static int device_open(struct inode*, struct file*);
 static int device_release(struct inode*, struct file*);
-static ssize_t device_read(struct file*, char*, size_t, loff_t*);
-static ssize_t device_write(struct file*, const char*, size_t, loff_t*);
+static ssize_t device_read_iter(struct kiocb*, struct iov_iter*);
+static ssize_t device_write_iter(struct kiocb*, struct iov_iter*);
+static int device_mmap(struct file*, struct vm_area_struct*);
+static loff_t device_llseek(struct file*, loff_t, int);
+static __poll_t device_poll(struct file*, struct poll_table_struct*);
 static long device_ioctl(struct file*, unsigned int, unsigned long);
+static long dispatch_ioctl_command(struct ioctl_string_ops_channel*, unsigned int, unsigned long);
 
 static struct file_operations file_ops = {.owner = THIS_MODULE,
-                                          .read = device_read,
-                                          .write = device_write,
+                                          .read_iter = device_read_iter,
+                                          .write_iter = device_write_iter,
+                                          .mmap = device_mmap,
+                                          .llseek = device_llseek,
+                                          .poll = device_poll,
+                                          .splice_read = copy_splice_read,
+                                          .splice_write = iter_file_splice_write,
                                           .open = device_open,
                                           .unlocked_ioctl = device_ioctl,
                                           .release = device_release};
 
-static void do_module_cleanup(void); // destroy character device, delete device files,
-                                     // delete class, unregister module
+// destroy character device, delete device files (the existing ones), delete class, unregister module, free channels,
+// remove stats files
+static void do_module_cleanup(uint existing_devices_count);
 
 static int ioctl_string_ops_init(void)
 {
@@ -56,22 +116,57 @@ static int ioctl_string_ops_init(void)
 
     do
     {
+        if (max_buffer_size == 0)
+        {
+            pr_alert("%s: invalid maximum data buffer size\n", THIS_MODULE->name);
+            break;
+        }
+
+        if (stream_buffer_size < 2 || stream_buffer_size > INT_MAX)
+        {
+            pr_alert("%s: invalid stream buffer size\n", THIS_MODULE->name);
+            break;
+        }
+
+        // at least one byte of record content should fit besides the record length
+        if (record_queue_size <= sizeof(u16) || record_queue_size > INT_MAX)
+        {
+            pr_alert("%s: invalid record queue size\n", THIS_MODULE->name);
+            break;
+        }
+
+        if (channels_count == 0 || channels_count > MAX_CHANNELS_COUNT)
+        {
+            pr_alert("%s: invalid channels count\n", THIS_MODULE->name);
+            break;
+        }
+
+        // nothing gets allocated besides the channels until the devices are used
+        set_buffer_sizes(max_buffer_size, max_prefix_size, stream_buffer_size, record_queue_size);
+
+        if (create_channels(channels_count) < 0)
+        {
+            pr_alert("%s: cannot create the channels\n", THIS_MODULE->name);
+            break;
+        }
+
         major_number = register_chrdev(major_number, THIS_MODULE->name, &file_ops);
 
         if (major_number < 0)
         {
             pr_alert("%s: registering char device failed\n", THIS_MODULE->name);
+            free_module_data();
             break;
         }
 
         cdev_init(&ioctl_string_ops_cdev, &file_ops);
 
-        int cdev_add_result = cdev_add(&ioctl_string_ops_cdev, major_number, SUPPORTED_MINOR_NUMBERS_COUNT);
+        int cdev_add_result = cdev_add(&ioctl_string_ops_cdev, major_number, channels_count);
 
         if (cdev_add_result < 0)
         {
             pr_alert("%s: cannot add device to the system\n", THIS_MODULE->name);
-            do_module_cleanup();
+            do_module_cleanup(0);
             break;
         }
 
@@ -80,19 +175,38 @@ static int ioctl_string_ops_init(void)
         if (!ioctl_string_ops_class)
         {
             pr_alert("%s: cannot create the struct class (ioctl_string_ops_class)\n", THIS_MODULE->name);
-            do_module_cleanup();
+            do_module_cleanup(0);
             break;
         }
 
-        if (!device_create(ioctl_string_ops_class, NULL, MKDEV(major_number, 0), NULL, "ioctlstringops"))
+        uint device_minor_number = 0;
+
+        for (; device_minor_number < channels_count; ++device_minor_number)
+        {
+            // the first device keeps its original name (single channel setups are not affected)
+            const struct device* device =
+                device_minor_number == 0
+                    ? device_create(ioctl_string_ops_class, NULL, MKDEV(major_number, 0), NULL, "ioctlstringops")
+                    : device_create(ioctl_string_ops_class, NULL, MKDEV(major_number, device_minor_number), NULL,
+                                    "ioctlstringops%u", device_minor_number);
+
+            if (!device)
+            {
+                pr_alert("%s: cannot create the device with minor %u!\n", THIS_MODULE->name, device_minor_number);
+                break;
+            }
+        }
+
+        if (device_minor_number != channels_count)
         {
-            pr_alert("%s: cannot create the device!\n", THIS_MODULE->name);
-            do_module_cleanup();
+            // destroy all previously created minor number devices (current number creation failed)
+            do_module_cleanup(device_minor_number);
             break;
         }
 
         result = SUCCESS;
         reset_module_data();
+        create_stats_files();
         pr_info("%s: device registered, major number %d successfully assigned\n", THIS_MODULE->name, major_number);
     } while (false);
 
@@ -101,25 +215,29 @@ static int ioctl_string_ops_init(void)
 
 static void ioctl_string_ops_exit(void)
 {
-    do_module_cleanup();
+    do_module_cleanup(channels_count);
     pr_info("%s: device with major number %d unregistered\n", THIS_MODULE->name, major_number);
 }
 
+/* Multiple files can be open at the same time (e.g. a writer and several readers), each having its own read position
+   within the channel of its minor number.
+*/
 static int device_open(struct inode* inode, struct file* file)
 {
-    int result = SUCCESS;
+    const int result = device_open_impl(inode, file);
 
-    if (!is_device_open)
+    if (result == SUCCESS)
     {
-        pr_info("%s: opening device\n", THIS_MODULE->name);
-
-        ++is_device_open;
+        hot_path_info("%s: opening device, minor number is: %u\n", THIS_MODULE->name, iminor(inode));
         try_module_get(THIS_MODULE);
     }
+    else if (result == -ENODEV)
+    {
+        pr_alert("%s: minor number %u is not supported!\n", THIS_MODULE->name, iminor(inode));
+    }
     else
     {
-        result = -EBUSY;
-        pr_warn("%s: device is busy\n", THIS_MODULE->name);
+        pr_err("%s: cannot allocate the file reading state\n", THIS_MODULE->name);
     }
 
     return result;
@@ -127,72 +245,160 @@ static int device_open(struct inode* inode, struct file* file)
 
 static int device_release(struct inode* inode, struct file* file)
 {
-    pr_info("%s: releasing device\n", THIS_MODULE->name);
+    hot_path_info("%s: releasing device\n", THIS_MODULE->name);
 
-    --is_device_open;
+    device_release_impl(inode, file);
     module_put(THIS_MODULE);
 
     return SUCCESS;
 }
 
-static ssize_t device_read(struct file* filp, char* buf, size_t length, loff_t* offset)
+// read()/write() are served by the iterator based operations as well (single segment iterators), splice()/sendfile()
+// rely on them too (the output is copied straight into the pipe pages, the input straight from them)
+static ssize_t device_read_iter(struct kiocb* iocb, struct iov_iter* to)
+{
+    return device_read_iter_impl(iocb, to);
+}
+
+static ssize_t device_write_iter(struct kiocb* iocb, struct iov_iter* from)
+{
+    return device_write_iter_impl(iocb, from);
+}
+
+static int device_mmap(struct file* filp, struct vm_area_struct* vma)
 {
-    return device_read_impl(filp, buf, length, offset);
+    return device_mmap_impl(filp, vma);
 }
 
-static ssize_t device_write(struct file* filp, const char* buf, size_t length, loff_t* offset)
+static loff_t device_llseek(struct file* filp, loff_t offset, int whence)
 {
-    return device_write_impl(filp, buf, length, offset);
+    return device_llseek_impl(filp, offset, whence);
 }
 
+static __poll_t device_poll(struct file* filp, struct poll_table_struct* wait)
+{
+    return device_poll_impl(filp, wait);
+}
+
+/* The commands apply to the channel of the file, serialized with its data buffer reads/writes (any open file). The read
+   filter is a setting of the file itself, the channel data doesn't get locked.
+*/
 static long device_ioctl(struct file* file, unsigned int command, unsigned long arg)
+{
+    long result = 0;
+    struct ioctl_string_ops_channel* const channel = get_file_channel(file);
+
+    count_ioctl_command(command);
+
+    if (command == IOCTL_SET_READ_FILTER)
+    {
+        result = ioctl_set_read_filter(file, (const struct ioctl_string_ops_read_filter*)arg);
+    }
+    else if (lock_channel_data(channel) < 0)
+    {
+        result = -ERESTARTSYS;
+    }
+    else
+    {
+        result = dispatch_ioctl_command(channel, command, arg);
+        unlock_channel_data(channel);
+    }
+
+    return result;
+}
+
+static long dispatch_ioctl_command(struct ioctl_string_ops_channel* channel, unsigned int command, unsigned long arg)
 {
     long result = 0;
 
     switch (command)
     {
     case IOCTL_DO_MODULE_RESET: {
-        result = ioctl_do_module_reset();
+        result = ioctl_do_module_reset(channel);
         break;
     }
     case IOCTL_IS_MODULE_RESET: {
-        result = ioctl_is_module_reset((bool*)arg);
+        result = ioctl_is_module_reset(channel, (bool*)arg);
         break;
     }
     case IOCTL_ENABLE_USER_INPUT_TRIMMING: {
-        result = ioctl_enable_user_input_trimming((bool*)arg);
+        result = ioctl_enable_user_input_trimming(channel, (bool*)arg);
         break;
     }
     case IOCTL_IS_USER_INPUT_TRIMMING_ENABLED: {
-        result = ioctl_is_user_input_trimming_enabled((bool*)arg);
+        result = ioctl_is_user_input_trimming_enabled(channel, (bool*)arg);
         break;
     }
     case IOCTL_GET_BUFFER_SIZE: {
-        result = ioctl_get_buffer_size((size_t*)arg);
+        result = ioctl_get_buffer_size(channel, (size_t*)arg);
         break;
     }
     case IOCTL_SET_OUTPUT_PREFIX: {
-        result = ioctl_set_output_prefix((void*)arg);
+        result = ioctl_set_output_prefix(channel, (void*)arg);
         break;
     }
     case IOCTL_GET_OUTPUT_PREFIX_SIZE: {
-        result = ioctl_get_output_prefix_size((size_t*)arg);
+        result = ioctl_get_output_prefix_size(channel, (size_t*)arg);
         break;
     }
     case IOCTL_ENABLE_INPUT_APPEND_MODE: {
-        result = ioctl_enable_input_append_mode((bool*)arg);
+        result = ioctl_enable_input_append_mode(channel, (bool*)arg);
         break;
     }
     case IOCTL_IS_INPUT_APPEND_MODE_ENABLED: {
-        result = ioctl_is_input_append_mode_enabled((bool*)arg);
+        result = ioctl_is_input_append_mode_enabled(channel, (bool*)arg);
         break;
     }
     case IOCTL_SET_MAX_OUTPUT_SIZE: {
-        result = ioctl_set_max_output_size((size_t*)arg);
+        result = ioctl_set_max_output_size(channel, (size_t*)arg);
         break;
     }
     case IOCTL_GET_MAX_OUTPUT_SIZE: {
-        result = ioctl_get_max_output_size((size_t*)arg);
+        result = ioctl_get_max_output_size(channel, (size_t*)arg);
+        break;
+    }
+    case IOCTL_SET_CONFIG: {
+        result = ioctl_set_config(channel, (struct ioctl_string_ops_config*)arg);
+        break;
+    }
+    case IOCTL_GET_STATE: {
+        result = ioctl_get_state(channel, (struct ioctl_string_ops_state*)arg);
+        break;
+    }
+    case IOCTL_ENABLE_WAIT_FOR_DATA: {
+        result = ioctl_enable_wait_for_data(channel, (bool*)arg);
+        break;
+    }
+    case IOCTL_IS_WAIT_FOR_DATA_ENABLED: {
+        result = ioctl_is_wait_for_data_enabled(channel, (bool*)arg);
+        break;
+    }
+    case IOCTL_ENABLE_STREAMING_MODE: {
+        result = ioctl_enable_streaming_mode(channel, (bool*)arg);
+        break;
+    }
+    case IOCTL_IS_STREAMING_MODE_ENABLED: {
+        result = ioctl_is_streaming_mode_enabled(channel, (bool*)arg);
+        break;
+    }
+    case IOCTL_ENABLE_RECORD_MODE: {
+        result = ioctl_enable_record_mode(channel, (bool*)arg);
+        break;
+    }
+    case IOCTL_IS_RECORD_MODE_ENABLED: {
+        result = ioctl_is_record_mode_enabled(channel, (bool*)arg);
+        break;
+    }
+    case IOCTL_DEQUEUE_RECORDS: {
+        result = ioctl_dequeue_records(channel, (struct ioctl_string_ops_records*)arg);
+        break;
+    }
+    case IOCTL_SET_COMPRESSION: {
+        result = ioctl_set_compression(channel, (const struct ioctl_string_ops_compression*)arg);
+        break;
+    }
+    case IOCTL_GET_COMPRESSION_STATS: {
+        result = ioctl_get_compression_stats(channel, (struct ioctl_string_ops_compression_stats*)arg);
         break;
     }
     default:
@@ -202,16 +408,23 @@ static long device_ioctl(struct file* file, unsigned int command, unsigned long
     return result;
 }
 
-static void do_module_cleanup()
+static void do_module_cleanup(uint existing_devices_count)
 {
+    remove_stats_files();
+
     if (ioctl_string_ops_class)
     {
-        device_destroy(ioctl_string_ops_class, MKDEV(major_number, 0));
+        for (uint device_minor_number = 0; device_minor_number < existing_devices_count; ++device_minor_number)
+        {
+            device_destroy(ioctl_string_ops_class, MKDEV(major_number, device_minor_number));
+        }
+
         class_destroy(ioctl_string_ops_class);
     }
 
     cdev_del(&ioctl_string_ops_cdev);
     unregister_chrdev(major_number, THIS_MODULE->name);
+    free_module_data();
 }
 
 module_init(ioctl_string_ops_init);
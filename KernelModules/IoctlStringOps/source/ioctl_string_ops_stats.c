@@ -0,0 +1,115 @@
+#include <linux/debugfs.h>
+#include <linux/module.h>
+#include <linux/percpu.h>
+#include <linux/seq_file.h>
+
+#include "ioctl_string_ops_stats.h"
+
+// ioctl commands are identified by lowercase letters (see the command numbers), any other command is counted as unknown
+#define FIRST_IOCTL_COMMAND_NUMBER 'a'
+#define IOCTL_COMMAND_NUMBERS_COUNT 26
+#define UNKNOWN_IOCTL_COMMAND_INDEX IOCTL_COMMAND_NUMBERS_COUNT
+
+struct operation_stats
+{
+    u64 counters[COUNTERS_COUNT];
+    u64 ioctl_calls[IOCTL_COMMAND_NUMBERS_COUNT + 1]; // last entry: unknown commands
+};
+
+static const char* const counter_names[COUNTERS_COUNT] = {[COUNTER_READS] = "reads",
+                                                          [COUNTER_WRITES] = "writes",
+                                                          [COUNTER_BYTES_OUT] = "bytes_out",
+                                                          [COUNTER_BYTES_IN] = "bytes_in",
+                                                          [COUNTER_TRUNCATED_WRITES] = "truncated_writes",
+                                                          [COUNTER_PREFIXED_READS] = "prefixed_reads"};
+
+// each CPU only updates its own copy (no shared cache lines, no atomics), the copies are summed up when read
+static DEFINE_PER_CPU(struct operation_stats, stats);
+
+static struct dentry* stats_dir = NULL;
+
+/***** HELPER FUNCTIONS *****/
+
+static void aggregate_stats(struct operation_stats* total)
+{
+    int cpu;
+
+    memset(total, 0, sizeof(*total));
+
+    for_each_possible_cpu(cpu)
+    {
+        const struct operation_stats* cpu_stats = per_cpu_ptr(&stats, cpu);
+
+        for (size_t index = 0; index < COUNTERS_COUNT; ++index)
+        {
+            total->counters[index] += READ_ONCE(cpu_stats->counters[index]);
+        }
+
+        for (size_t index = 0; index <= IOCTL_COMMAND_NUMBERS_COUNT; ++index)
+        {
+            total->ioctl_calls[index] += READ_ONCE(cpu_stats->ioctl_calls[index]);
+        }
+    }
+}
+
+static int stats_show(struct seq_file* file, void* data)
+{
+    struct operation_stats total;
+
+    aggregate_stats(&total);
+
+    for (size_t index = 0; index < COUNTERS_COUNT; ++index)
+    {
+        seq_printf(file, "%s: %llu\n", counter_names[index], total.counters[index]);
+    }
+
+    for (size_t index = 0; index < IOCTL_COMMAND_NUMBERS_COUNT; ++index)
+    {
+        if (total.ioctl_calls[index] > 0)
+        {
+            seq_printf(file, "ioctl_%c: %llu\n", (char)(FIRST_IOCTL_COMMAND_NUMBER + index), total.ioctl_calls[index]);
+        }
+    }
+
+    seq_printf(file, "ioctl_unknown: %llu\n", total.ioctl_calls[UNKNOWN_IOCTL_COMMAND_INDEX]);
+
+    return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(stats);
+
+/***** STATS FUNCTIONS *****/
+
+void increment_counter(enum ioctl_string_ops_counter counter)
+{
+    this_cpu_inc(stats.counters[counter]);
+}
+
+void add_to_counter(enum ioctl_string_ops_counter counter, size_t value)
+{
+    this_cpu_add(stats.counters[counter], value);
+}
+
+void count_ioctl_command(unsigned int command)
+{
+    const unsigned int command_number = _IOC_NR(command);
+    const size_t index = command_number >= FIRST_IOCTL_COMMAND_NUMBER &&
+                                 command_number < FIRST_IOCTL_COMMAND_NUMBER + IOCTL_COMMAND_NUMBERS_COUNT
+                             ? command_number - FIRST_IOCTL_COMMAND_NUMBER
+                             : UNKNOWN_IOCTL_COMMAND_INDEX;
+
+    this_cpu_inc(stats.ioctl_calls[index]);
+}
+
+void create_stats_files(void)
+{
+    // debugfs errors are not checked on purpose (the subsequent calls handle them gracefully)
+    stats_dir = debugfs_create_dir(THIS_MODULE->name, NULL);
+    debugfs_create_file("stats", 0444, stats_dir, NULL, &stats_fops);
+}
+
+void remove_stats_files(void)
+{
+    debugfs_remove_recursive(stats_dir);
+    stats_dir = NULL;
+}
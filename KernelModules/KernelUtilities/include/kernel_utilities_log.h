@@ -0,0 +1,44 @@
+#pragma once
+
+#include <linux/compiler.h>
+#include <linux/printk.h>
+
+/* Logging facility for the frequently executed code paths (read/write, sysfs store, issued commands, etc):
+   - info messages are logged with pr_info() if the hot path log level is HOT_PATH_LOG_LEVEL_INFO or higher
+   - debug messages (e.g. buffer contents) are logged with pr_debug() if the level is HOT_PATH_LOG_LEVEL_DEBUG, so they
+     are additionally subject to dynamic debug (if enabled, the call sites should be activated via its control file)
+   The level is a parameter of the kernel_utilities module that can be changed at runtime
+   (/sys/module/kernel_utilities/parameters/hot_path_log_level), values other than the levels below are rejected. A
+   disabled message costs one (unlikely) branch, the messages above HOT_PATH_LOG_MAX_LEVEL are removed at compile time
+   (the level can be lowered via EXTRA_CFLAGS).
+*/
+#define HOT_PATH_LOG_LEVEL_OFF 0
+#define HOT_PATH_LOG_LEVEL_INFO 1
+#define HOT_PATH_LOG_LEVEL_DEBUG 2
+
+#ifndef HOT_PATH_LOG_MAX_LEVEL
+#define HOT_PATH_LOG_MAX_LEVEL HOT_PATH_LOG_LEVEL_DEBUG
+#endif
+
+extern int hot_path_log_level;
+
+#define is_hot_path_log_enabled(level)                                                                                 \
+    ((level) <= HOT_PATH_LOG_MAX_LEVEL && unlikely((level) <= READ_ONCE(hot_path_log_level)))
+
+#define hot_path_info(fmt, ...)                                                                                        \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (is_hot_path_log_enabled(HOT_PATH_LOG_LEVEL_INFO))                                                          \
+        {                                                                                                              \
+            pr_info(fmt, ##__VA_ARGS__);                                                                               \
+        }                                                                                                              \
+    } while (false)
+
+#define hot_path_debug(fmt, ...)                                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (is_hot_path_log_enabled(HOT_PATH_LOG_LEVEL_DEBUG))                                                         \
+        {                                                                                                              \
+            pr_debug(fmt, ##__VA_ARGS__);                                                                              \
+        }                                                                                                              \
+    } while (false)
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <linux/types.h>
+
+// transforms applied by transform_and_copy_string() (any combination, the lower case conversion takes precedence)
+#define STRING_TRANSFORM_TRIM 0b00000001
+#define STRING_TRANSFORM_TO_LOWER_CASE 0b00000010
+#define STRING_TRANSFORM_TO_UPPER_CASE 0b00000100
+#define STRING_TRANSFORM_REVERSE 0b00001000
+
+/* Single pass over src, same result as executing the requested transforms one after the other (in any order): the
+   trimming only narrows the range of src to be copied, the chars are then copied 8 at a time (word taken from the end
+   of the range and byte swapped if reversing, case converted with SWAR arithmetic if it contains only ASCII chars).
+   Returns the length of the resulting string (0 if src cannot be copied to dest, see max_chars_count).
+*/
+size_t transform_and_copy_string(char* dest, const char* src, size_t max_chars_count, unsigned int transforms,
+                                 const char* calling_module_name);
+
+// in place variants (no '\0' required, e.g. chunks of a stream), same word at a time processing
+void convert_to_same_case_in_place(char* str, size_t chars_count, bool to_lower_case);
+void reverse_in_place(char* str, size_t chars_count);
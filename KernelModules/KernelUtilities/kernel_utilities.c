@@ -1,13 +1,45 @@
 #include <linux/ctype.h>
 #include <linux/init.h>
+#include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/moduleparam.h>
-#include <linux/slab.h>
+#include <linux/swab.h>
+
+#include "kernel_utilities_log.h"
+#include "kernel_utilities_string.h"
 
 MODULE_LICENSE("GPL");
 MODULE_DESCRIPTION("This module is a utitilies appliance used by other kernel modules.\n");
 MODULE_AUTHOR("Liviu Popa");
 
+/* PARAMETERS */
+
+// verbosity of the hot path messages logged by the modules using the utilities (see kernel_utilities_log.h)
+int hot_path_log_level = HOT_PATH_LOG_LEVEL_OFF;
+
+// only the HOT_PATH_LOG_LEVEL_* values are accepted (-EINVAL otherwise, the current level is kept)
+static int set_hot_path_log_level(const char* value, const struct kernel_param* param)
+{
+    int new_level;
+    int result = kstrtoint(value, 0, &new_level);
+
+    if (result == 0 && (new_level < HOT_PATH_LOG_LEVEL_OFF || new_level > HOT_PATH_LOG_LEVEL_DEBUG))
+    {
+        result = -EINVAL;
+    }
+
+    if (result == 0)
+    {
+        WRITE_ONCE(*(int*)param->arg, new_level);
+    }
+
+    return result;
+}
+
+static const struct kernel_param_ops hot_path_log_level_ops = {.set = set_hot_path_log_level, .get = param_get_int};
+
+module_param_cb(hot_path_log_level, &hot_path_log_level_ops, &hot_path_log_level, S_IRUSR | S_IWUSR);
+
 static bool can_copy_to_destination(const char* dest, const char* src, size_t max_chars_count,
                                     const char* calling_module_name, const char* calling_function_name)
 {
@@ -63,99 +95,182 @@ static bool can_copy_to_destination(const char* dest, const char* src, size_t ma
     return can_copy;
 }
 
-void trim_and_copy_string(char* dest, const char* src, size_t max_chars_count, const char* calling_module_name)
+// REPEAT_BYTE() is sized for unsigned long (32 bits on 32-bit kernels), the words are always 64 bits wide here
+#define REPEAT_BYTE_U64(byte) (0x0101010101010101ULL * (u8)(byte))
+
+/* Converts the case of 8 ASCII chars at once (SWAR), the word should have no high bit set. Adding 0x80 - first to an
+   ASCII char sets its high bit if the char is not lower than first, no carry reaching the next char. The high bits of
+   the chars within [first, last] are shifted to the case bit (0x20) which gets toggled.
+*/
+static u64 convert_ascii_word_case(u64 word, bool to_lower_case)
+{
+    const u64 first = to_lower_case ? 'A' : 'a';
+    const u64 last = to_lower_case ? 'Z' : 'z';
+    const u64 not_below_first = word + REPEAT_BYTE_U64(0x80 - first);
+    const u64 above_last = word + REPEAT_BYTE_U64(0x80 - last - 1);
+    const u64 in_range_high_bits = not_below_first & ~above_last & REPEAT_BYTE_U64(0x80);
+
+    return word ^ (in_range_high_bits >> 2);
+}
+
+// byte by byte (in place) conversion, used for the non-ASCII chars (kernel ctype rules)
+static void convert_chars_case(char* str, size_t chars_count, bool to_lower_case)
+{
+    for (size_t index = 0; index < chars_count; ++index)
+    {
+        str[index] = to_lower_case ? tolower(str[index]) : toupper(str[index]);
+    }
+}
+
+size_t transform_and_copy_string(char* dest, const char* src, size_t max_chars_count, unsigned int transforms,
+                                 const char* calling_module_name)
 {
+    size_t length = 0;
+
     const char* module_name = calling_module_name ? calling_module_name : "INVALID MODULE NAME";
 
-    do
+    if (can_copy_to_destination(dest, src, max_chars_count, module_name, __func__))
     {
-        if (!can_copy_to_destination(dest, src, max_chars_count, module_name, __func__))
+        const bool should_reverse = transforms & STRING_TRANSFORM_REVERSE;
+        const bool should_convert_case = transforms & (STRING_TRANSFORM_TO_LOWER_CASE | STRING_TRANSFORM_TO_UPPER_CASE);
+        const bool to_lower_case = transforms & STRING_TRANSFORM_TO_LOWER_CASE;
+        const char* start = src;
+
+        length = strlen(src);
+
+        if (transforms & STRING_TRANSFORM_TRIM)
         {
-            break;
+            while (length > 0 && isspace(*start))
+            {
+                ++start;
+                --length;
+            }
+
+            while (length > 0 && isspace(start[length - 1]))
+            {
+                --length;
+            }
         }
 
-        memset(dest, '\0', max_chars_count);
+        memset(dest + length, '\0', max_chars_count - length);
 
-        char* temp = kzalloc(max_chars_count, GFP_KERNEL);
+        size_t index = 0;
 
-        if (temp == NULL)
+        for (; index + sizeof(u64) <= length; index += sizeof(u64))
         {
-            pr_err("%s: trim_and_copy_string : memory could not be allocated!\n", module_name);
-            break;
-        }
+            u64 word;
 
-        memset(temp, '\0', max_chars_count);
-        strncpy(temp, src, max_chars_count - 1);
+            memcpy(&word, should_reverse ? start + length - index - sizeof(word) : start + index, sizeof(word));
 
-        const size_t temp_length = strlen(temp);
+            // byte swapping reverses the chars in memory regardless of endianness
+            if (should_reverse)
+            {
+                word = swab64(word);
+            }
 
-        if (temp_length == 0)
-        {
-            break;
-        }
+            const bool is_ascii_word = !(word & REPEAT_BYTE_U64(0x80));
 
-        size_t left_index = 0;
-        size_t right_index = temp_length - 1;
+            if (should_convert_case && is_ascii_word)
+            {
+                word = convert_ascii_word_case(word, to_lower_case);
+            }
 
-        while (left_index <= right_index && isspace(temp[left_index]))
-        {
-            ++left_index;
+            memcpy(dest + index, &word, sizeof(word));
+
+            if (should_convert_case && !is_ascii_word)
+            {
+                convert_chars_case(dest + index, sizeof(word), to_lower_case);
+            }
         }
 
-        while (left_index < right_index && isspace(temp[right_index]))
+        // remaining chars (not filling a word)
+        for (; index < length; ++index)
         {
-            --right_index;
+            dest[index] = should_reverse ? start[length - 1 - index] : start[index];
         }
 
-        const size_t length = right_index >= left_index ? right_index - left_index + 1 : 0;
-        const char* start = temp + left_index;
+        if (should_convert_case)
+        {
+            convert_chars_case(dest + length - length % sizeof(u64), length % sizeof(u64), to_lower_case);
+        }
+    }
 
-        strncpy(dest, start, length);
-        kfree(temp);
-    } while (false);
+    return length;
 }
 
-void convert_to_same_case_and_copy_string(char* dest, const char* src, size_t max_chars_count, bool to_lower_case,
-                                          const char* calling_module_name)
+void convert_to_same_case_in_place(char* str, size_t chars_count, bool to_lower_case)
 {
-    const char* module_name = calling_module_name ? calling_module_name : "INVALID MODULE NAME";
+    size_t index = 0;
 
-    if (can_copy_to_destination(dest, src, max_chars_count, module_name, __func__))
+    for (; index + sizeof(u64) <= chars_count; index += sizeof(u64))
     {
-        memset(dest, '\0', max_chars_count);
+        u64 word;
 
-        if (to_lower_case)
+        memcpy(&word, str + index, sizeof(word));
+
+        if (word & REPEAT_BYTE_U64(0x80))
         {
-            for (size_t index = 0; index < strlen(src); ++index)
-            {
-                dest[index] = tolower(src[index]);
-            }
+            convert_chars_case(str + index, sizeof(word), to_lower_case);
         }
         else
         {
-            for (size_t index = 0; index < strlen(src); ++index)
-            {
-                dest[index] = toupper(src[index]);
-            }
+            word = convert_ascii_word_case(word, to_lower_case);
+            memcpy(str + index, &word, sizeof(word));
         }
     }
+
+    convert_chars_case(str + index, chars_count - index, to_lower_case);
 }
 
-void reverse_and_copy_string(char* dest, const char* src, size_t max_chars_count, const char* calling_module_name)
+void reverse_in_place(char* str, size_t chars_count)
 {
-    const char* module_name = calling_module_name ? calling_module_name : "INVALID MODULE NAME";
+    size_t left_index = 0;
+    size_t right_index = chars_count; // one past the last char of the range not reversed yet
 
-    if (can_copy_to_destination(dest, src, max_chars_count, module_name, __func__))
+    // the words at both ends of the range are byte swapped and exchanged
+    while (right_index - left_index >= 2 * sizeof(u64))
     {
-        memset(dest, '\0', max_chars_count);
+        u64 left_word;
+        u64 right_word;
 
-        const size_t length = strlen(src);
+        memcpy(&left_word, str + left_index, sizeof(left_word));
+        memcpy(&right_word, str + right_index - sizeof(right_word), sizeof(right_word));
 
-        for (size_t index = 0; index < length; ++index)
-        {
-            dest[index] = src[length - 1 - index];
-        }
+        left_word = swab64(left_word);
+        right_word = swab64(right_word);
+
+        memcpy(str + left_index, &right_word, sizeof(right_word));
+        memcpy(str + right_index - sizeof(left_word), &left_word, sizeof(left_word));
+
+        left_index += sizeof(u64);
+        right_index -= sizeof(u64);
     }
+
+    while (right_index - left_index >= 2)
+    {
+        const char left_char = str[left_index];
+
+        str[left_index++] = str[--right_index];
+        str[right_index] = left_char;
+    }
+}
+
+void trim_and_copy_string(char* dest, const char* src, size_t max_chars_count, const char* calling_module_name)
+{
+    transform_and_copy_string(dest, src, max_chars_count, STRING_TRANSFORM_TRIM, calling_module_name);
+}
+
+void convert_to_same_case_and_copy_string(char* dest, const char* src, size_t max_chars_count, bool to_lower_case,
+                                          const char* calling_module_name)
+{
+    transform_and_copy_string(dest, src, max_chars_count,
+                              to_lower_case ? STRING_TRANSFORM_TO_LOWER_CASE : STRING_TRANSFORM_TO_UPPER_CASE,
+                              calling_module_name);
+}
+
+void reverse_and_copy_string(char* dest, const char* src, size_t max_chars_count, const char* calling_module_name)
+{
+    transform_and_copy_string(dest, src, max_chars_count, STRING_TRANSFORM_REVERSE, calling_module_name);
 }
 
 int get_average(const int* array, size_t array_size)
@@ -175,7 +290,11 @@ int get_average(const int* array, size_t array_size)
 EXPORT_SYMBOL(trim_and_copy_string);
 EXPORT_SYMBOL(convert_to_same_case_and_copy_string);
 EXPORT_SYMBOL(reverse_and_copy_string);
+EXPORT_SYMBOL(transform_and_copy_string);
+EXPORT_SYMBOL(convert_to_same_case_in_place);
+EXPORT_SYMBOL(reverse_in_place);
 EXPORT_SYMBOL(get_average);
+EXPORT_SYMBOL(hot_path_log_level);
 
 static int utilities_init(void)
 {
@@ -1,5 +1,6 @@
 #include <linux/module.h>
 
+#include "kernel_utilities_log.h"
 #include "mapping_impl.h"
 
 #define ENULLDATAOBJECT 2
@@ -68,7 +69,7 @@ static void update_map_element(void)
 
             data->map_elements[index]->value = data->value;
             should_add_element = 0;
-            pr_info("%s: updated element: (key: %s, value: %d)\n", THIS_MODULE->name, data->key, data->value);
+            hot_path_info("%s: updated element: (key: %s, value: %d)\n", THIS_MODULE->name, data->key, data->value);
             break;
         }
 
@@ -95,7 +96,7 @@ static void update_map_element(void)
 
         data->map_elements[data->map_elements_count] = element_data;
         ++data->map_elements_count;
-        pr_info("%s: added element: (key: %s, value: %d)\n", THIS_MODULE->name, data->key, data->value);
+        hot_path_info("%s: added element: (key: %s, value: %d)\n", THIS_MODULE->name, data->key, data->value);
         reset_key_and_value();
     } while (false);
 }
@@ -131,7 +132,7 @@ static void remove_map_element(void)
 
             data->map_elements[data->map_elements_count - 1] = NULL;
             --data->map_elements_count;
-            pr_info("%s: removed element with key: %s\n", THIS_MODULE->name, data->key);
+            hot_path_info("%s: removed element with key: %s\n", THIS_MODULE->name, data->key);
             break;
         }
 
@@ -163,7 +164,8 @@ static void retrieve_map_element_value(void)
 
             element_found = 1;
             data->value = data->map_elements[index]->value;
-            pr_info("%s: retrieved value %d for element with key %s\n", THIS_MODULE->name, data->value, data->key);
+            hot_path_info("%s: retrieved value %d for element with key %s\n", THIS_MODULE->name, data->value,
+                          data->key);
             break;
         }
 
@@ -190,7 +192,7 @@ static void erase_map_elements(void)
 
         if (data->map_elements_count > 0)
         {
-            pr_info("%s: erased all map elements\n", THIS_MODULE->name);
+            hot_path_info("%s: erased all map elements\n", THIS_MODULE->name);
         }
         else
         {
@@ -255,7 +257,7 @@ void store_key(const char* key_str)
         trim_and_copy_string(data->key, key_str, MAX_KEY_STR_LENGTH, THIS_MODULE->name);
         memset(data->status, '\0', MAX_STATUS_STR_LENGTH);
         strncpy(data->status, dirty_status_str, strlen(dirty_status_str));
-        pr_info("%s: key entered: %s\n", THIS_MODULE->name, data->key);
+        hot_path_info("%s: key entered: %s\n", THIS_MODULE->name, data->key);
     }
     else
     {
@@ -271,7 +273,7 @@ int store_value(const char* value_str)
     {
         memset(data->status, '\0', MAX_STATUS_STR_LENGTH);
         strncpy(data->status, dirty_status_str, strlen(dirty_status_str));
-        pr_info("%s: value entered: %d\n", THIS_MODULE->name, data->value);
+        hot_path_info("%s: value entered: %d\n", THIS_MODULE->name, data->value);
     }
     else if (result == -ENULLDATAOBJECT)
     {
@@ -288,7 +290,7 @@ void store_command(const char* command_str)
         trim_and_copy_string(data->command, command_str, MAX_COMMAND_STR_LENGTH, THIS_MODULE->name);
         const size_t command_length = strlen(data->command);
 
-        pr_info("%s: issued command: %s\n", THIS_MODULE->name, data->command);
+        hot_path_info("%s: issued command: %s\n", THIS_MODULE->name, data->command);
 
         if (command_length == update_command_length &&
             strncmp(data->command, update_command, update_command_length) == 0)
@@ -1,15 +1,96 @@
 #pragma once
 
 #define SUCCESS 0
-#define INPUT_BUFFER_SIZE 128
-#define DATA_BUFFER_SIZE 256
+#define DEFAULT_INPUT_BUFFER_SIZE 128
+#define DEFAULT_DATA_BUFFER_SIZE 256
+#define DEFAULT_STREAM_BUFFER_SIZE 16384
+
+// "; " followed by maximum 20 digits, appended to the output by the "append length" operation
+#define MAX_LENGTH_SUFFIX_LENGTH 22
+
 #define SUPPORTED_MINOR_NUMBERS_COUNT 4
-#define TO_LOWER_CASE true
 
-ssize_t device_read_impl(struct file* filp, char* buffer, size_t length, loff_t* offset, int minor_number);
-ssize_t device_write_impl(struct file* filp, const char* buffer, size_t length, loff_t* offset, int minor_number);
+#define PIPELINE_OP_TRIM 1
+#define PIPELINE_OP_TO_LOWER_CASE 2
+#define PIPELINE_OP_TO_UPPER_CASE 3
+#define PIPELINE_OP_REVERSE 4
+#define PIPELINE_OP_APPEND_LENGTH 5 // "; <length>" appended to the transformed string (if not empty)
+#define MAX_PIPELINE_OPS_COUNT 8
+#define MAX_BATCH_ITEMS_COUNT 1024
+
+/* Used by the "set/get pipeline" ioctls: operations applied in order to the input written to a minor number (1-3),
+   the default pipelines being trim + lower case (minor 1), trim + reverse (minor 2) and trim + append length (minor 3).
+   Each operation can be used once, the case conversions exclude each other and appending the length should be the
+   last operation. The pipeline is executed in a single pass over the user input and applies to the subsequent writes.
+   The last user input (minor 0) is trimmed regardless of the pipelines, an input that is empty after trimming still
+   clears the content of the written minor number.
+*/
+struct string_ops_pipeline
+{
+    uint32_t ops_count; // 0: the user input is copied as it is
+    uint8_t ops[MAX_PIPELINE_OPS_COUNT];
+};
+
+// input/output strings of the "transform batch" ioctl, the status and output length are written back by the module
+struct string_ops_batch_item
+{
+    const char* input;
+    size_t input_length;    // at most input buffer size - 1 (E2BIG), the input ends earlier if it contains '\0'
+    char* output;           // receives the result, terminating '\0' included
+    size_t output_capacity; // ENOSPC if the result and its terminating '\0' don't fit (output left unchanged)
+    size_t output_length;   // length of the result (also written back on ENOSPC as required capacity - 1)
+    int32_t status;         // 0 or negative error code
+};
+
+/* Used by the "transform batch" ioctl: the pipeline of the minor number (1-3) is applied to each item within a single
+   syscall, the items being independent of each other. The content of the minor number and the last user input
+   (minor 0) are not changed. Item errors are reported per item, the ioctl fails only if the items cannot be accessed.
+*/
+struct string_ops_batch
+{
+    struct string_ops_batch_item* items;
+    uint32_t items_count; // at most MAX_BATCH_ITEMS_COUNT
+};
+
+ssize_t device_read_impl(struct file* filp, char* buffer, size_t length, loff_t* offset);
+ssize_t device_write_impl(struct file* filp, const char* buffer, size_t length, loff_t* offset);
+loff_t device_llseek_impl(struct file* filp, loff_t offset, int whence); // -ESPIPE in streaming mode
+
+// the per file state (minor number, content generation) is kept as file private data, minor number validated by caller
+int device_open_impl(struct file* filp, int minor_number);
+void device_release_impl(struct file* filp);
+int get_file_minor_number(const struct file* filp);
 
-void link_minor_number_data(int minor_number);
 bool is_valid_minor_number(int minor_number);
 
+// the pipeline of the minor number of the file is accessed (minor 0 has no pipeline)
+long ioctl_set_pipeline(struct file* filp, const struct string_ops_pipeline* pipeline);
+long ioctl_get_pipeline(struct file* filp, struct string_ops_pipeline* pipeline);
+
+long ioctl_transform_batch(struct file* filp, const struct string_ops_batch* batch);
+
+/* Streaming mode (minor numbers 1-3): the written chunks are transformed by the pipeline as they arrive and queued into
+   a bounded stream buffer (module parameter), the reads dequeuing the result. Writers wait for space and readers for
+   data (EAGAIN if O_NONBLOCK). The "end stream" ioctl marks the end of the payload: the trailing whitespaces held back
+   while trimming are dropped, the length gets appended and the readers get EOF once everything got read (the next
+   write starts a new payload, it waits until then). A reversing pipeline requires the whole payload, which is provided
+   after the end of the stream and cannot exceed the stream buffer (ENOSPC). The pipeline cannot be changed while
+   streaming and the streamed writes don't update the last user input (minor 0).
+*/
+long ioctl_enable_streaming_mode(struct file* filp, const bool* should_stream);
+long ioctl_end_stream(struct file* filp);
+
+/* The minor number of the file gets back to its initial (idle) state: content cleared and buffers released, default
+   pipeline, streaming disabled. Resetting minor 0 clears the last user input.
+*/
+long ioctl_reset_minor_number(struct file* filp);
+
+/* The buffers are allocated on first write (stream buffer: when enabling streaming) and released on reset (ioctl),
+   sizes are validated by caller (data buffer not smaller than input buffer, non-empty stream buffer)
+*/
+void set_buffer_sizes(size_t input_buffer_size, size_t data_buffer_size, size_t stream_buffer_size);
+
+// should be called before the devices get created (the per minor number locks are initialized)
+void init_module_data(void);
 void reset_module_data(void);
+void free_module_data(void);
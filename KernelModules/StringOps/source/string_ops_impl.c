@@ -1,138 +1,690 @@
+#include <linux/ctype.h>
+#include <linux/fs.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/slab.h>
+#include <linux/wait.h>
 
+#include "kernel_utilities_log.h"
+#include "kernel_utilities_string.h"
 #include "string_ops_impl.h"
 
-extern void trim_and_copy_string(char* dest, const char* src, size_t max_str_length, const char* calling_module_name);
-extern void convert_to_same_case_and_copy_string(char* dest, const char* src, size_t chars_count, int to_lower_case,
-                                                 const char* calling_module_name); // minor 1 operation
-extern void reverse_and_copy_string(char* dest, const char* src, size_t chars_count,
-                                    const char* calling_module_name); // minor 2 operation
+/* The buffers are allocated on first write to a minor number and released when the minor number gets reset (ioctl),
+   so the unused minor numbers don't take any memory. Their sizes are module parameters.
+*/
+static size_t input_buffer_size = DEFAULT_INPUT_BUFFER_SIZE;
+static size_t data_buffer_size = DEFAULT_DATA_BUFFER_SIZE;
+static size_t stream_buffer_size = DEFAULT_STREAM_BUFFER_SIZE;
 
-static char input_buffer[INPUT_BUFFER_SIZE]; // shared input buffer (used by any minor number)
-static char minor1_buffer[DATA_BUFFER_SIZE]; // data buffer for minor 1
-static char minor2_buffer[DATA_BUFFER_SIZE]; // data buffer for minor 2
-static char minor3_buffer[DATA_BUFFER_SIZE]; // data buffer for minor 3
+// "; " followed by maximum 20 digits and the terminating '\0'
+#define LENGTH_SUFFIX_SIZE 24
 
-static char* current_buffer_ptr = NULL; // can point to any buffer depending on minor number and operation (read/write)
+/* Streaming mode state of a minor number (see the "enable streaming mode" ioctl). The chunks are queued linearly, the
+   unread content being moved to the beginning of the buffer when the next chunk doesn't fit at its end.
+*/
+struct stream_data
+{
+    char* buffer;                           // stream_buffer_size chars
+    size_t head;                            // next char to be read
+    size_t readable_tail;                   // end of the readable chars (trailing whitespaces held back if trimming)
+    size_t tail;                            // end of the queued (transformed) chars
+    size_t length;                          // number of chars of the transformed payload (appended when ended)
+    char length_suffix[LENGTH_SUFFIX_SIZE]; // "; <length>", read after the payload once the stream ended
+    size_t length_suffix_index;             // next suffix char to be read
+    size_t length_suffix_length;
+    bool is_started; // a non-whitespace char got queued (leading whitespaces skipped if trimming)
+    bool is_ended;
+};
+
+/* Each minor number has its own buffers and lock, so the minor numbers can be written and read in parallel (e.g. by
+   different clients). Writing to a minor number also updates the last user input read by minor 0, in which case the
+   minor 0 lock is acquired while holding the lock of the written minor number (never the other way around).
+*/
+struct minor_number_data
+{
+    char* data_buffer;      // minor 0: last user input (any minor number), other minor numbers: operation output
+    char* input_buffer;     // user input after trimming (writable minor numbers only)
+    char* raw_input_buffer; // user input before trimming (writable minor numbers only)
+    struct string_ops_pipeline pipeline; // writable minor numbers only
+    unsigned int transforms;             // pipeline operations translated to STRING_TRANSFORM_* flags
+    bool should_append_length;
+    u64 content_generation;              // incremented each time the content gets replaced (write, reset)
+    struct stream_data* stream;          // NULL if streaming is disabled
+    u64 stream_events_count;             // incremented on each stream change the waiters might be interested in
+    wait_queue_head_t stream_wait_queue; // readers waiting for data, writers waiting for space
+    struct mutex lock;
+};
+
+static const struct string_ops_pipeline default_pipelines[SUPPORTED_MINOR_NUMBERS_COUNT] = {
+    {0, {0}},
+    {2, {PIPELINE_OP_TRIM, PIPELINE_OP_TO_LOWER_CASE}},
+    {2, {PIPELINE_OP_TRIM, PIPELINE_OP_REVERSE}},
+    {2, {PIPELINE_OP_TRIM, PIPELINE_OP_APPEND_LENGTH}}};
+
+static struct minor_number_data minor_numbers_data[SUPPORTED_MINOR_NUMBERS_COUNT];
+
+/* Per file state (private data), each file reads the content of its minor number from its own position (file offset).
+   Once the content gets replaced (written through any file), the position refers to the new content and reading
+   starts over from its beginning.
+*/
+struct file_data
+{
+    int minor_number;
+    u64 content_generation; // generation of the content the file position refers to
+};
 
-static void append_input_string_length(void)
+static void release_buffer(char** buffer)
 {
-    if (current_buffer_ptr)
+    kfree(*buffer);
+    *buffer = NULL;
+}
+
+// returns false if the buffers required by the minor number could not be allocated
+static bool allocate_buffers(struct minor_number_data* data)
+{
+    if (!data->input_buffer)
+    {
+        data->input_buffer = kzalloc(input_buffer_size, GFP_KERNEL);
+    }
+
+    if (!data->raw_input_buffer)
     {
-        const size_t length = strlen(input_buffer);
+        data->raw_input_buffer = kzalloc(input_buffer_size, GFP_KERNEL);
+    }
+
+    if (!data->data_buffer)
+    {
+        data->data_buffer = kzalloc(data_buffer_size, GFP_KERNEL);
+    }
 
-        if (length > 0)
+    return data->input_buffer && data->raw_input_buffer && data->data_buffer;
+}
+
+// minor number reset: the content is dropped along with the buffers
+static void release_buffers(struct minor_number_data* data)
+{
+    release_buffer(&data->data_buffer);
+    release_buffer(&data->input_buffer);
+    release_buffer(&data->raw_input_buffer);
+    ++data->content_generation;
+}
+
+// the trimmed input becomes the minor 0 content, an empty input clears it (no buffer allocated for it)
+static bool publish_last_input(const char* input)
+{
+    struct minor_number_data* const last_input_data = &minor_numbers_data[0];
+
+    mutex_lock(&last_input_data->lock);
+
+    if (!last_input_data->data_buffer && input[0] != '\0')
+    {
+        last_input_data->data_buffer = kzalloc(input_buffer_size, GFP_KERNEL);
+    }
+
+    if (last_input_data->data_buffer)
+    {
+        strscpy(last_input_data->data_buffer, input, input_buffer_size);
+        ++last_input_data->content_generation;
+    }
+
+    const bool is_published = input[0] == '\0' || last_input_data->data_buffer;
+
+    mutex_unlock(&last_input_data->lock);
+
+    return is_published;
+}
+
+static unsigned int get_operation_transform(uint8_t operation)
+{
+    return operation == PIPELINE_OP_TRIM            ? STRING_TRANSFORM_TRIM
+           : operation == PIPELINE_OP_TO_LOWER_CASE ? STRING_TRANSFORM_TO_LOWER_CASE
+           : operation == PIPELINE_OP_TO_UPPER_CASE ? STRING_TRANSFORM_TO_UPPER_CASE
+           : operation == PIPELINE_OP_REVERSE       ? STRING_TRANSFORM_REVERSE
+                                                    : 0;
+}
+
+// returns false if the pipeline is invalid (see struct string_ops_pipeline)
+static bool get_pipeline_transforms(const struct string_ops_pipeline* pipeline, unsigned int* transforms,
+                                    bool* should_append_length)
+{
+    const unsigned int case_transforms = STRING_TRANSFORM_TO_LOWER_CASE | STRING_TRANSFORM_TO_UPPER_CASE;
+    bool is_valid = pipeline->ops_count <= MAX_PIPELINE_OPS_COUNT;
+
+    *transforms = 0;
+    *should_append_length = false;
+
+    for (uint32_t index = 0; is_valid && index < pipeline->ops_count; ++index)
+    {
+        const unsigned int transform = get_operation_transform(pipeline->ops[index]);
+        const unsigned int conflicting_transforms = transform & case_transforms ? case_transforms : transform;
+
+        if (*should_append_length)
+        {
+            is_valid = false; // appending the length should be the last operation
+        }
+        else if (pipeline->ops[index] == PIPELINE_OP_APPEND_LENGTH)
         {
-            sprintf(current_buffer_ptr, "%s; %ld", input_buffer, length);
+            *should_append_length = true;
         }
         else
         {
-            memset(current_buffer_ptr, '\0', DATA_BUFFER_SIZE);
+            is_valid = transform != 0 && !(*transforms & conflicting_transforms);
+            *transforms |= transform;
         }
     }
+
+    return is_valid;
 }
 
-static void write_to_current_buffer(int minor_number, const char* raw_input_buffer)
+// the result (data buffer sized destination) is returned as string length, the input should fit the input buffer
+static size_t apply_pipeline(char* dest, const char* src, unsigned int transforms, bool should_append_length)
 {
-    trim_and_copy_string(input_buffer, raw_input_buffer, INPUT_BUFFER_SIZE, THIS_MODULE->name);
-
-    pr_info("%s: after trimming the user provided string was stored to minor number %d as: %s\n", THIS_MODULE->name,
-            minor_number, input_buffer);
+    // the transforms are fused into one pass, the length is appended afterwards (length preserving transforms)
+    size_t length = transform_and_copy_string(dest, src, data_buffer_size, transforms, THIS_MODULE->name);
 
-    switch (minor_number)
+    if (should_append_length && length > 0)
     {
-    case 1: {
-        convert_to_same_case_and_copy_string(current_buffer_ptr, input_buffer, DATA_BUFFER_SIZE, TO_LOWER_CASE,
-                                             THIS_MODULE->name);
-        break;
+        length += (size_t)scnprintf(dest + length, data_buffer_size - length, "; %zu", length);
     }
-    case 2: {
-        reverse_and_copy_string(current_buffer_ptr, input_buffer, DATA_BUFFER_SIZE, THIS_MODULE->name);
-        break;
+
+    return length;
+}
+
+static void write_to_data_buffer(struct minor_number_data* data, int minor_number)
+{
+    transform_and_copy_string(data->input_buffer, data->raw_input_buffer, input_buffer_size, STRING_TRANSFORM_TRIM,
+                              THIS_MODULE->name);
+
+    hot_path_debug("%s: after trimming the user provided string was stored to minor number %d as: %s\n",
+                   THIS_MODULE->name, minor_number, data->input_buffer);
+
+    apply_pipeline(data->data_buffer, data->raw_input_buffer, data->transforms, data->should_append_length);
+}
+
+static bool is_reversing_stream(const struct minor_number_data* data)
+{
+    return data->transforms & STRING_TRANSFORM_REVERSE;
+}
+
+// number of chars that can be dequeued (a reversed stream is only available once ended)
+static size_t get_stream_readable_chars_count(const struct minor_number_data* data)
+{
+    const struct stream_data* const stream = data->stream;
+
+    return is_reversing_stream(data) && !stream->is_ended ? 0 : stream->readable_tail - stream->head;
+}
+
+static bool is_stream_drained(const struct stream_data* stream)
+{
+    return stream->is_ended && stream->head == stream->readable_tail &&
+           stream->length_suffix_index == stream->length_suffix_length;
+}
+
+static void reset_stream(struct stream_data* stream)
+{
+    char* const buffer = stream->buffer;
+
+    memset(stream, 0, sizeof(struct stream_data));
+    stream->buffer = buffer;
+}
+
+static void free_stream(struct minor_number_data* data)
+{
+    if (data->stream)
+    {
+        kvfree(data->stream->buffer);
+        kfree(data->stream);
+        data->stream = NULL;
     }
-    case 3: {
-        append_input_string_length();
-        break;
+}
+
+// the waiters (readers waiting for data, writers waiting for space) recheck the stream
+static void notify_stream_event(struct minor_number_data* data)
+{
+    WRITE_ONCE(data->stream_events_count, data->stream_events_count + 1);
+    wake_up_interruptible(&data->stream_wait_queue);
+}
+
+/* Waits (minor number lock not held) until the stream changes, i.e. the events count differs from the one read under
+   the lock before releasing it. Returns 0 if the caller should retry.
+*/
+static int wait_for_stream_event(struct minor_number_data* data, const struct file* filp, u64 events_count)
+{
+    int result = 0;
+
+    if (filp->f_flags & O_NONBLOCK)
+    {
+        result = -EAGAIN;
     }
-    default:
-        break;
+    else if (wait_event_interruptible(data->stream_wait_queue, READ_ONCE(data->stream_events_count) != events_count))
+    {
+        result = -ERESTARTSYS;
     }
+
+    return result;
 }
 
-static bool can_write_to_minor_number(int minor_number)
+// the unread content is moved to the beginning of the stream buffer to make room for the next chunk
+static void compact_stream(struct stream_data* stream)
 {
-    return is_valid_minor_number(minor_number) && minor_number != 0;
+    memmove(stream->buffer, stream->buffer + stream->head, stream->tail - stream->head);
+
+    stream->readable_tail -= stream->head;
+    stream->tail -= stream->head;
+    stream->head = 0;
 }
 
-ssize_t device_read_impl(struct file* filp, char* buffer, size_t length, loff_t* offset, int minor_number)
+// the pipeline transforms (except reversing, applied at the end of the stream) are applied to the queued chunk
+static void transform_stream_chunk(struct minor_number_data* data, size_t chars_count)
 {
-    ssize_t result = -1;
+    struct stream_data* const stream = data->stream;
+    char* const chunk = stream->buffer + stream->tail;
+    size_t chunk_length = chars_count;
 
-    if (current_buffer_ptr)
+    if ((data->transforms & STRING_TRANSFORM_TRIM) && !stream->is_started)
     {
-        ssize_t read_bytes_count = 0;
-        const char* const output_buffer_start_ptr = current_buffer_ptr;
+        size_t leading_whitespaces_count = 0;
 
-        while (length && *current_buffer_ptr != '\0')
+        while (leading_whitespaces_count < chunk_length && isspace(chunk[leading_whitespaces_count]))
         {
-            put_user(*(current_buffer_ptr++), buffer++);
-            --length;
-            read_bytes_count++;
+            ++leading_whitespaces_count;
         }
 
-        result = read_bytes_count;
+        chunk_length -= leading_whitespaces_count;
+        memmove(chunk, chunk + leading_whitespaces_count, chunk_length);
+    }
 
-        pr_info("%s: user read from minor number %d: %s", THIS_MODULE->name, minor_number, output_buffer_start_ptr);
+    if (data->transforms & (STRING_TRANSFORM_TO_LOWER_CASE | STRING_TRANSFORM_TO_UPPER_CASE))
+    {
+        convert_to_same_case_in_place(chunk, chunk_length, data->transforms & STRING_TRANSFORM_TO_LOWER_CASE);
+    }
+
+    stream->tail += chunk_length;
+    stream->is_started = stream->is_started || chunk_length > 0;
+
+    const size_t previous_readable_tail = stream->readable_tail;
+
+    if (!(data->transforms & STRING_TRANSFORM_TRIM))
+    {
+        stream->readable_tail = stream->tail;
     }
     else
     {
-        // defensive programming, output buffer should be set in read mode
-        pr_err("%s: cannot read, NULL output buffer!", THIS_MODULE->name);
+        // the trailing whitespaces are held back until followed by other chars (dropped if ending the stream)
+        for (size_t index = stream->tail; index > stream->readable_tail; --index)
+        {
+            if (!isspace(stream->buffer[index - 1]))
+            {
+                stream->readable_tail = index;
+                break;
+            }
+        }
     }
 
+    stream->length += stream->readable_tail - previous_readable_tail;
+}
+
+/* Should be called with the minor number lock held. Returns the number of bytes consumed from user, 0 if the stream
+   buffer is full or the ended payload is not read yet (the readers should free space first) or a negative error code.
+*/
+static ssize_t write_to_stream(struct minor_number_data* data, const char* buffer, size_t length)
+{
+    ssize_t result = 0;
+    struct stream_data* const stream = data->stream;
+
+    do
+    {
+        if (stream->is_ended)
+        {
+            // the previous payload should be read first, the writer waits same as for a full stream buffer
+            if (!is_stream_drained(stream))
+            {
+                break;
+            }
+
+            reset_stream(stream);
+        }
+
+        if (stream->tail + length > stream_buffer_size && stream->head > 0)
+        {
+            compact_stream(stream);
+        }
+
+        const size_t free_chars_count = stream_buffer_size - stream->tail;
+
+        if (free_chars_count == 0)
+        {
+            // nothing to be read that could free space (reversed payload or held back whitespaces filling the buffer)
+            result = get_stream_readable_chars_count(data) > 0 ? 0 : -ENOSPC;
+            break;
+        }
+
+        const size_t chars_count = length < free_chars_count ? length : free_chars_count;
+
+        if (copy_from_user(stream->buffer + stream->tail, buffer, chars_count) > 0)
+        {
+            result = -EFAULT;
+            break;
+        }
+
+        transform_stream_chunk(data, chars_count);
+        result = (ssize_t)chars_count;
+
+        hot_path_debug("%s: user streamed %zu chars\n", THIS_MODULE->name, chars_count);
+    } while (false);
+
     return result;
 }
 
-ssize_t device_write_impl(struct file* filp, const char* buffer, size_t length, loff_t* offset, int minor_number)
+// should be called with the minor number lock held, returns 0 if there is nothing to read (yet)
+static ssize_t read_from_stream(struct minor_number_data* data, char* buffer, size_t length)
 {
-    ssize_t result = -EINVAL;
+    ssize_t result = 0;
+    struct stream_data* const stream = data->stream;
 
-    if (can_write_to_minor_number(minor_number))
+    const size_t readable_chars_count = get_stream_readable_chars_count(data);
+    const bool is_suffix_read = readable_chars_count == 0 && stream->is_ended;
+    const char* const output = is_suffix_read ? stream->length_suffix + stream->length_suffix_index
+                                              : stream->buffer + stream->head;
+    const size_t available_chars_count =
+        is_suffix_read ? stream->length_suffix_length - stream->length_suffix_index : readable_chars_count;
+    const size_t chars_to_read_count = length < available_chars_count ? length : available_chars_count;
+
+    if (copy_to_user(buffer, output, chars_to_read_count) > 0)
     {
-        char raw_input_buffer[INPUT_BUFFER_SIZE];
-        memset(raw_input_buffer, '\0', INPUT_BUFFER_SIZE);
+        result = -EFAULT;
+    }
+    else
+    {
+        if (is_suffix_read)
+        {
+            stream->length_suffix_index += chars_to_read_count;
+        }
+        else
+        {
+            stream->head += chars_to_read_count;
+        }
 
-        const size_t max_bytes_to_copy_count = INPUT_BUFFER_SIZE - 1;
+        if (stream->head == stream->tail)
+        {
+            stream->head = 0;
+            stream->readable_tail = 0;
+            stream->tail = 0;
+        }
+
+        result = (ssize_t)chars_to_read_count;
+    }
+
+    return result;
+}
+
+static void end_stream(struct minor_number_data* data)
+{
+    struct stream_data* const stream = data->stream;
+
+    stream->tail = stream->readable_tail; // trailing whitespaces dropped
+
+    if (is_reversing_stream(data))
+    {
+        reverse_in_place(stream->buffer + stream->head, stream->readable_tail - stream->head);
+    }
+
+    if (data->should_append_length && stream->length > 0)
+    {
+        stream->length_suffix_length =
+            (size_t)scnprintf(stream->length_suffix, sizeof(stream->length_suffix), "; %zu", stream->length);
+    }
+
+    stream->is_ended = true;
+}
+
+static bool can_write_to_minor_number(int minor_number)
+{
+    return is_valid_minor_number(minor_number) && minor_number != 0;
+}
+
+// should be called with the minor number lock held
+static ssize_t write_to_minor_number(struct minor_number_data* data, const char* buffer, size_t length,
+                                     int minor_number)
+{
+    ssize_t result = -ENOMEM;
+
+    if (!allocate_buffers(data))
+    {
+        pr_err("%s: cannot allocate the buffers for minor number %d!\n", THIS_MODULE->name, minor_number);
+    }
+    else
+    {
+        memset(data->raw_input_buffer, '\0', input_buffer_size);
+
+        const size_t max_bytes_to_copy_count = input_buffer_size - 1;
         const size_t bytes_to_copy_count = length > max_bytes_to_copy_count ? max_bytes_to_copy_count : length;
-        const size_t bytes_not_copied_count = copy_from_user(raw_input_buffer, buffer, bytes_to_copy_count);
+        const size_t bytes_not_copied_count = copy_from_user(data->raw_input_buffer, buffer, bytes_to_copy_count);
 
         if (bytes_not_copied_count > 0)
         {
             pr_warn("%s: %ld bytes could not be copied from user\n", THIS_MODULE->name, bytes_not_copied_count);
         }
 
-        result = (ssize_t)strlen(
-            raw_input_buffer); // the total number of chars provided by user (not the trimmed one) needs to be returned
+        // the total number of chars provided by user (not the trimmed one) needs to be returned
+        result = (ssize_t)strlen(data->raw_input_buffer);
 
-        pr_info("%s: user wrote to minor number %d: %s\n", THIS_MODULE->name, minor_number, raw_input_buffer);
+        hot_path_debug("%s: user wrote to minor number %d: %s\n", THIS_MODULE->name, minor_number,
+                       data->raw_input_buffer);
 
-        write_to_current_buffer(minor_number, raw_input_buffer);
+        write_to_data_buffer(data, minor_number);
+        ++data->content_generation;
+
+        if (!publish_last_input(data->input_buffer))
+        {
+            pr_err("%s: cannot allocate the buffer for minor number 0!\n", THIS_MODULE->name);
+            result = -ENOMEM;
+        }
     }
-    else
+
+    return result;
+}
+
+// should be called with the minor number lock held, the content is read from the file position
+static ssize_t read_from_data_buffer(struct minor_number_data* data, struct file_data* file_data, char* buffer,
+                                     size_t length, loff_t* offset)
+{
+    ssize_t result = 0;
+
+    if (file_data->content_generation != data->content_generation)
+    {
+        file_data->content_generation = data->content_generation;
+        *offset = 0;
+    }
+
+    // nothing written yet to the minor number (or reset meanwhile): no buffer allocated, no output
+    if (data->data_buffer)
     {
-        pr_err("%s: unsupported write operation for minor number %d!\n", THIS_MODULE->name, minor_number);
+        const size_t content_length = strlen(data->data_buffer);
+        const size_t read_index = *offset < content_length ? (size_t)*offset : content_length;
+        const size_t chars_left_count = content_length - read_index;
+        const size_t chars_to_read_count = length < chars_left_count ? length : chars_left_count;
+        const char* const output = data->data_buffer + read_index;
+
+        if (copy_to_user(buffer, output, chars_to_read_count) > 0)
+        {
+            result = -EFAULT;
+        }
+        else
+        {
+            *offset += chars_to_read_count;
+            result = (ssize_t)chars_to_read_count;
+
+            hot_path_debug("%s: user read from minor number %d: %.*s", THIS_MODULE->name, file_data->minor_number,
+                           (int)chars_to_read_count, output);
+        }
     }
 
     return result;
 }
 
-void link_minor_number_data(int minor_number)
+ssize_t device_read_impl(struct file* filp, char* buffer, size_t length, loff_t* offset)
 {
-    current_buffer_ptr = minor_number == 0   ? input_buffer
-                         : minor_number == 1 ? minor1_buffer
-                         : minor_number == 2 ? minor2_buffer
-                         : minor_number == 3 ? minor3_buffer
-                                             : NULL;
+    ssize_t result = 0;
+    bool should_wait = false;
+
+    struct file_data* const file_data = filp->private_data;
+    struct minor_number_data* const data = &minor_numbers_data[file_data->minor_number];
+
+    do
+    {
+        if (mutex_lock_interruptible(&data->lock))
+        {
+            result = -ERESTARTSYS;
+            break;
+        }
+
+        const u64 stream_events_count = data->stream_events_count;
+
+        if (data->stream)
+        {
+            result = read_from_stream(data, buffer, length);
+            should_wait = result == 0 && length > 0 && !data->stream->is_ended;
+
+            if (result > 0)
+            {
+                notify_stream_event(data);
+            }
+        }
+        else
+        {
+            result = read_from_data_buffer(data, file_data, buffer, length, offset);
+        }
+
+        mutex_unlock(&data->lock);
+
+        if (should_wait)
+        {
+            result = wait_for_stream_event(data, filp, stream_events_count);
+        }
+    } while (should_wait && result == 0);
+
+    return result;
+}
+
+ssize_t device_write_impl(struct file* filp, const char* buffer, size_t length, loff_t* offset)
+{
+    ssize_t result = -EINVAL;
+    bool should_wait = false;
+
+    struct file_data* const file_data = filp->private_data;
+    const int minor_number = file_data->minor_number;
+    struct minor_number_data* const data = &minor_numbers_data[minor_number];
+
+    do
+    {
+        if (!can_write_to_minor_number(minor_number))
+        {
+            pr_err("%s: unsupported write operation for minor number %d!\n", THIS_MODULE->name, minor_number);
+            break;
+        }
+
+        if (mutex_lock_interruptible(&data->lock))
+        {
+            result = -ERESTARTSYS;
+            break;
+        }
+
+        const u64 stream_events_count = data->stream_events_count;
+
+        if (data->stream)
+        {
+            result = write_to_stream(data, buffer, length);
+            should_wait = result == 0 && length > 0;
+
+            if (result > 0)
+            {
+                notify_stream_event(data);
+            }
+        }
+        else
+        {
+            result = write_to_minor_number(data, buffer, length, minor_number);
+        }
+
+        mutex_unlock(&data->lock);
+
+        if (should_wait)
+        {
+            result = wait_for_stream_event(data, filp, stream_events_count);
+        }
+    } while (should_wait && result == 0);
+
+    return result;
+}
+
+int device_open_impl(struct file* filp, int minor_number)
+{
+    int result = -ENOMEM;
+    struct minor_number_data* const data = &minor_numbers_data[minor_number];
+    struct file_data* const file_data = kzalloc(sizeof(struct file_data), GFP_KERNEL);
+
+    do
+    {
+        if (!file_data)
+        {
+            break;
+        }
+
+        if (mutex_lock_interruptible(&data->lock))
+        {
+            kfree(file_data);
+            result = -ERESTARTSYS;
+            break;
+        }
+
+        // the file position refers to the current content
+        file_data->content_generation = data->content_generation;
+        mutex_unlock(&data->lock);
+
+        file_data->minor_number = minor_number;
+        filp->private_data = file_data;
+        result = SUCCESS;
+    } while (false);
+
+    return result;
+}
+
+loff_t device_llseek_impl(struct file* filp, loff_t offset, int whence)
+{
+    loff_t result = -ERESTARTSYS;
+
+    struct file_data* const file_data = filp->private_data;
+    struct minor_number_data* const data = &minor_numbers_data[file_data->minor_number];
+
+    if (!mutex_lock_interruptible(&data->lock))
+    {
+        if (data->stream)
+        {
+            result = -ESPIPE; // no position within a stream
+        }
+        else
+        {
+            // the new position refers to the current content (not reset by the next read)
+            file_data->content_generation = data->content_generation;
+            result = fixed_size_llseek(filp, offset, whence, data->data_buffer ? strlen(data->data_buffer) : 0);
+        }
+
+        mutex_unlock(&data->lock);
+    }
+
+    return result;
+}
+
+void device_release_impl(struct file* filp)
+{
+    kfree(filp->private_data);
+    filp->private_data = NULL;
+}
+
+int get_file_minor_number(const struct file* filp)
+{
+    return ((const struct file_data*)filp->private_data)->minor_number;
 }
 
 bool is_valid_minor_number(int minor_number)
@@ -140,10 +692,346 @@ bool is_valid_minor_number(int minor_number)
     return minor_number >= 0 && minor_number < SUPPORTED_MINOR_NUMBERS_COUNT;
 }
 
+long ioctl_set_pipeline(struct file* filp, const struct string_ops_pipeline* pipeline)
+{
+    long result = -EINVAL;
+    const int minor_number = get_file_minor_number(filp);
+
+    do
+    {
+        if (!can_write_to_minor_number(minor_number))
+        {
+            pr_err("%s: IOCTL: minor number %d has no pipeline!\n", THIS_MODULE->name, minor_number);
+            break;
+        }
+
+        struct string_ops_pipeline new_pipeline;
+
+        if (!pipeline || copy_from_user(&new_pipeline, pipeline, sizeof(new_pipeline)) > 0)
+        {
+            pr_err("%s: IOCTL: failed updating the pipeline!\n", THIS_MODULE->name);
+            result = -EFAULT;
+            break;
+        }
+
+        unsigned int transforms;
+        bool should_append_length;
+
+        if (!get_pipeline_transforms(&new_pipeline, &transforms, &should_append_length))
+        {
+            pr_err("%s: IOCTL: invalid pipeline for minor number %d!\n", THIS_MODULE->name, minor_number);
+            break;
+        }
+
+        struct minor_number_data* const data = &minor_numbers_data[minor_number];
+
+        if (mutex_lock_interruptible(&data->lock))
+        {
+            result = -ERESTARTSYS;
+            break;
+        }
+
+        // the queued chunks are already transformed
+        if (data->stream)
+        {
+            pr_err("%s: IOCTL: the pipeline cannot be changed while streaming!\n", THIS_MODULE->name);
+            result = -EBUSY;
+        }
+        else
+        {
+            data->pipeline = new_pipeline;
+            data->transforms = transforms;
+            data->should_append_length = should_append_length;
+            result = SUCCESS;
+        }
+
+        mutex_unlock(&data->lock);
+    } while (false);
+
+    return result;
+}
+
+long ioctl_get_pipeline(struct file* filp, struct string_ops_pipeline* pipeline)
+{
+    long result = -EINVAL;
+    const int minor_number = get_file_minor_number(filp);
+
+    do
+    {
+        if (!can_write_to_minor_number(minor_number) || !pipeline)
+        {
+            break;
+        }
+
+        struct minor_number_data* const data = &minor_numbers_data[minor_number];
+
+        if (mutex_lock_interruptible(&data->lock))
+        {
+            result = -ERESTARTSYS;
+            break;
+        }
+
+        const struct string_ops_pipeline current_pipeline = data->pipeline;
+
+        mutex_unlock(&data->lock);
+
+        if (copy_to_user(pipeline, &current_pipeline, sizeof(current_pipeline)) > 0)
+        {
+            pr_err("%s: IOCTL: failed reading the pipeline!\n", THIS_MODULE->name);
+            result = -EFAULT;
+            break;
+        }
+
+        result = SUCCESS;
+    } while (false);
+
+    return result;
+}
+
+long ioctl_transform_batch(struct file* filp, const struct string_ops_batch* batch)
+{
+    long result = -EINVAL;
+    const int minor_number = get_file_minor_number(filp);
+    char* input = NULL;
+    char* output = NULL;
+
+    do
+    {
+        struct string_ops_batch new_batch;
+
+        if (!can_write_to_minor_number(minor_number) || !batch ||
+            copy_from_user(&new_batch, batch, sizeof(new_batch)) > 0 || new_batch.items_count > MAX_BATCH_ITEMS_COUNT)
+        {
+            pr_err("%s: IOCTL: invalid batch for minor number %d!\n", THIS_MODULE->name, minor_number);
+            break;
+        }
+
+        struct minor_number_data* const data = &minor_numbers_data[minor_number];
+
+        if (mutex_lock_interruptible(&data->lock))
+        {
+            result = -ERESTARTSYS;
+            break;
+        }
+
+        // the items are transformed without holding the lock (pipeline changes apply to the next batch)
+        const unsigned int transforms = data->transforms;
+        const bool should_append_length = data->should_append_length;
+
+        mutex_unlock(&data->lock);
+
+        // allocated once per batch and shared by all items
+        input = kmalloc(input_buffer_size, GFP_KERNEL);
+        output = kmalloc(data_buffer_size, GFP_KERNEL);
+
+        if (!input || !output)
+        {
+            pr_err("%s: IOCTL: cannot allocate the batch buffers!\n", THIS_MODULE->name);
+            result = -ENOMEM;
+            break;
+        }
+
+        result = SUCCESS;
+
+        for (uint32_t item_index = 0; item_index < new_batch.items_count; ++item_index)
+        {
+            struct string_ops_batch_item* const user_item = &new_batch.items[item_index];
+            struct string_ops_batch_item item;
+
+            if (copy_from_user(&item, user_item, sizeof(item)) > 0)
+            {
+                result = -EFAULT;
+                break;
+            }
+
+            item.output_length = 0;
+
+            if (item.input_length > input_buffer_size - 1)
+            {
+                item.status = -E2BIG;
+            }
+            else if (copy_from_user(input, item.input, item.input_length) > 0)
+            {
+                item.status = -EFAULT;
+            }
+            else
+            {
+                input[item.input_length] = '\0';
+                item.output_length = apply_pipeline(output, input, transforms, should_append_length);
+
+                if (item.output_length >= item.output_capacity)
+                {
+                    item.status = -ENOSPC;
+                }
+                else
+                {
+                    item.status = copy_to_user(item.output, output, item.output_length + 1) > 0 ? -EFAULT : SUCCESS;
+                }
+            }
+
+            if (put_user(item.output_length, &user_item->output_length) || put_user(item.status, &user_item->status))
+            {
+                result = -EFAULT;
+                break;
+            }
+        }
+
+        if (result == -EFAULT)
+        {
+            pr_err("%s: IOCTL: cannot access the batch items!\n", THIS_MODULE->name);
+        }
+    } while (false);
+
+    kfree(input);
+    kfree(output);
+
+    return result;
+}
+
+long ioctl_enable_streaming_mode(struct file* filp, const bool* should_stream)
+{
+    long result = -EINVAL;
+    const int minor_number = get_file_minor_number(filp);
+    struct minor_number_data* const data = &minor_numbers_data[minor_number];
+
+    do
+    {
+        bool should_enable;
+
+        if (!can_write_to_minor_number(minor_number) || !should_stream ||
+            copy_from_user(&should_enable, should_stream, sizeof(should_enable)) > 0)
+        {
+            pr_err("%s: IOCTL: failed updating the streaming mode of minor number %d!\n", THIS_MODULE->name,
+                   minor_number);
+            break;
+        }
+
+        // allocated upfront, released below if not needed (streaming already enabled)
+        struct stream_data* stream = should_enable ? kzalloc(sizeof(struct stream_data), GFP_KERNEL) : NULL;
+
+        if (stream)
+        {
+            stream->buffer = kvmalloc(stream_buffer_size, GFP_KERNEL);
+        }
+
+        if (should_enable && (!stream || !stream->buffer))
+        {
+            pr_err("%s: IOCTL: cannot allocate the stream buffer!\n", THIS_MODULE->name);
+            result = -ENOMEM;
+        }
+        else if (mutex_lock_interruptible(&data->lock))
+        {
+            result = -ERESTARTSYS;
+        }
+        else
+        {
+            if (should_enable != (data->stream != NULL))
+            {
+                free_stream(data); // disabling: the unread content is discarded
+                data->stream = stream;
+                stream = NULL;
+                notify_stream_event(data);
+            }
+
+            mutex_unlock(&data->lock);
+            result = SUCCESS;
+        }
+
+        if (stream)
+        {
+            kvfree(stream->buffer);
+            kfree(stream);
+        }
+    } while (false);
+
+    return result;
+}
+
+long ioctl_reset_minor_number(struct file* filp)
+{
+    long result = -ERESTARTSYS;
+    const int minor_number = get_file_minor_number(filp);
+    struct minor_number_data* const data = &minor_numbers_data[minor_number];
+
+    if (!mutex_lock_interruptible(&data->lock))
+    {
+        release_buffers(data);
+
+        if (data->stream)
+        {
+            free_stream(data); // the unread content is discarded, the waiters get notified
+            notify_stream_event(data);
+        }
+
+        data->pipeline = default_pipelines[minor_number];
+        get_pipeline_transforms(&data->pipeline, &data->transforms, &data->should_append_length);
+
+        mutex_unlock(&data->lock);
+        result = SUCCESS;
+    }
+
+    return result;
+}
+
+long ioctl_end_stream(struct file* filp)
+{
+    long result = -EINVAL;
+    struct minor_number_data* const data = &minor_numbers_data[get_file_minor_number(filp)];
+
+    if (mutex_lock_interruptible(&data->lock))
+    {
+        result = -ERESTARTSYS;
+    }
+    else
+    {
+        if (data->stream)
+        {
+            if (!data->stream->is_ended)
+            {
+                end_stream(data);
+                notify_stream_event(data);
+            }
+
+            result = SUCCESS;
+        }
+
+        mutex_unlock(&data->lock);
+    }
+
+    return result;
+}
+
+void set_buffer_sizes(size_t new_input_buffer_size, size_t new_data_buffer_size, size_t new_stream_buffer_size)
+{
+    input_buffer_size = new_input_buffer_size;
+    data_buffer_size = new_data_buffer_size;
+    stream_buffer_size = new_stream_buffer_size;
+}
+
+void init_module_data(void)
+{
+    for (int minor_number = 0; minor_number < SUPPORTED_MINOR_NUMBERS_COUNT; ++minor_number)
+    {
+        struct minor_number_data* const data = &minor_numbers_data[minor_number];
+
+        mutex_init(&data->lock);
+        init_waitqueue_head(&data->stream_wait_queue);
+        data->pipeline = default_pipelines[minor_number];
+        get_pipeline_transforms(&data->pipeline, &data->transforms, &data->should_append_length);
+    }
+}
+
+// no content is kept when the buffers are released
 void reset_module_data(void)
 {
-    memset(input_buffer, '\0', INPUT_BUFFER_SIZE);
-    memset(minor1_buffer, '\0', DATA_BUFFER_SIZE);
-    memset(minor2_buffer, '\0', DATA_BUFFER_SIZE);
-    memset(minor3_buffer, '\0', DATA_BUFFER_SIZE);
+    free_module_data();
+}
+
+void free_module_data(void)
+{
+    for (int minor_number = 0; minor_number < SUPPORTED_MINOR_NUMBERS_COUNT; ++minor_number)
+    {
+        release_buffers(&minor_numbers_data[minor_number]);
+        free_stream(&minor_numbers_data[minor_number]);
+    }
 }
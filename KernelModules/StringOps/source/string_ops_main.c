@@ -3,10 +3,20 @@
 #include <linux/fs.h>
 #include <linux/kernel.h>
 #include <linux/module.h>
+#include <linux/moduleparam.h>
 #include <linux/uaccess.h>
 
+#include "kernel_utilities_log.h"
 #include "string_ops_impl.h"
 
+// 9999 is an arbitrarily chosen "magic number" (same as for the other modules)
+#define IOCTL_SET_PIPELINE _IOW(9999, 'a', struct string_ops_pipeline*)
+#define IOCTL_GET_PIPELINE _IOR(9999, 'b', struct string_ops_pipeline*)
+#define IOCTL_ENABLE_STREAMING_MODE _IOW(9999, 'c', bool*)
+#define IOCTL_END_STREAM _IOW(9999, 'd', void*)
+#define IOCTL_TRANSFORM_BATCH _IOWR(9999, 'e', struct string_ops_batch*)
+#define IOCTL_RESET_MINOR_NUMBER _IOW(9999, 'f', void*)
+
 MODULE_LICENSE("GPL");
 
 MODULE_DESCRIPTION(
@@ -16,27 +26,53 @@ MODULE_DESCRIPTION(
     "- 1: user provided string is converted to lower-case\n"
     "- 2: user provided string is trimmed and reverted\n"
     "- 3: the length of the (trimmed) user provided string is calculated and appended to (trimmed) string\n"
-    "Any other minor number is not supported and no operation will be performed.\n");
+    "Any other minor number is not supported and no operation will be performed.\n"
+    "The operations of minor numbers 1-3 can be replaced by a pipeline of operations (ioctl).\n"
+    "Minor numbers 1-3 can stream arbitrarily large inputs through their pipeline (ioctl).\n"
+    "Minor numbers 1-3 can apply their pipeline to a batch of strings within a single call (ioctl).\n"
+    "Each minor number can be reset to its initial state, releasing its buffers (ioctl).\n");
 
 MODULE_AUTHOR("Liviu Popa");
 
+/* PARAMETERS */
+
+// maximum number of chars accepted from user per write, terminating '\0' included (shared by all minor numbers)
+static ulong input_buffer_size = DEFAULT_INPUT_BUFFER_SIZE;
+
+module_param(input_buffer_size, ulong, S_IRUSR);
+
+// size of the data buffer of each writable minor number (any input along with its length suffix should fit into it)
+static ulong data_buffer_size = DEFAULT_DATA_BUFFER_SIZE;
+
+module_param(data_buffer_size, ulong, S_IRUSR);
+
+// maximum number of chars queued by each minor number in streaming mode (allocated when enabling streaming)
+static ulong stream_buffer_size = DEFAULT_STREAM_BUFFER_SIZE;
+
+module_param(stream_buffer_size, ulong, S_IRUSR);
+
 static struct class* string_ops_class = NULL;
 static struct cdev string_ops_cdev;
 
 static int major_number = 0;
-static int minor_number = -1;
-static int is_device_open = 0;
 
 static int device_open(struct inode*, struct file*);
 static int device_release(struct inode*, struct file*);
 static ssize_t device_read(struct file*, char*, size_t, loff_t*);
 static ssize_t device_write(struct file*, const char*, size_t, loff_t*);
+static loff_t device_llseek(struct file*, loff_t, int);
+static long device_ioctl(struct file*, unsigned int, unsigned long);
 
-static struct file_operations file_ops = {
-    .owner = THIS_MODULE, .read = device_read, .write = device_write, .open = device_open, .release = device_release};
+static struct file_operations file_ops = {.owner = THIS_MODULE,
+                                          .read = device_read,
+                                          .write = device_write,
+                                          .open = device_open,
+                                          .llseek = device_llseek,
+                                          .unlocked_ioctl = device_ioctl,
+                                          .release = device_release};
 
 static void do_module_cleanup(size_t existing_minor_numbers_count); // destroy character device, delete device files,
-                                                                    // delete class, unregister module
+                                                                    // delete class, unregister module, free buffers
 
 static int string_ops_init(void)
 {
@@ -44,6 +80,16 @@ static int string_ops_init(void)
 
     do
     {
+        if (input_buffer_size < 2 || data_buffer_size < input_buffer_size ||
+            data_buffer_size - input_buffer_size < MAX_LENGTH_SUFFIX_LENGTH || stream_buffer_size == 0)
+        {
+            pr_alert("%s: invalid input/data/stream buffer size\n", THIS_MODULE->name);
+            break;
+        }
+
+        set_buffer_sizes(input_buffer_size, data_buffer_size, stream_buffer_size);
+        init_module_data();
+
         major_number = register_chrdev(major_number, THIS_MODULE->name, &file_ops);
 
         if (major_number < 0)
@@ -106,33 +152,26 @@ static void string_ops_exit(void)
     pr_info("%s: device with major number %d unregistered\n", THIS_MODULE->name, major_number);
 }
 
+// the minor numbers can be opened concurrently, any number of times (each file has its own read position)
 static int device_open(struct inode* inode, struct file* file)
 {
-    int result = -1;
+    int result = -ENODEV;
+    const int minor_number = iminor(inode);
 
-    if (!is_device_open)
-    {
-        minor_number = iminor(inode);
+    hot_path_info("%s: opening device, minor number is: %d\n", THIS_MODULE->name, minor_number);
 
-        pr_info("%s: opening device, minor number is: %d\n", THIS_MODULE->name, minor_number);
+    if (is_valid_minor_number(minor_number))
+    {
+        result = device_open_impl(file, minor_number);
 
-        if (is_valid_minor_number(minor_number))
+        if (result == SUCCESS)
         {
-            result = SUCCESS;
-
-            link_minor_number_data(minor_number);
-            ++is_device_open;
             try_module_get(THIS_MODULE);
         }
-        else
-        {
-            pr_alert("%s: minor number %d is not supported!\n", THIS_MODULE->name, minor_number);
-        }
     }
     else
     {
-        result = -EBUSY;
-        pr_warn("%s: device is busy\n", THIS_MODULE->name);
+        pr_alert("%s: minor number %d is not supported!\n", THIS_MODULE->name, minor_number);
     }
 
     return result;
@@ -140,9 +179,9 @@ static int device_open(struct inode* inode, struct file* file)
 
 static int device_release(struct inode* inode, struct file* file)
 {
-    pr_info("%s: releasing device, minor number is: %d\n", THIS_MODULE->name, minor_number);
+    hot_path_info("%s: releasing device, minor number is: %d\n", THIS_MODULE->name, get_file_minor_number(file));
 
-    --is_device_open;
+    device_release_impl(file);
     module_put(THIS_MODULE);
 
     return SUCCESS;
@@ -150,12 +189,54 @@ static int device_release(struct inode* inode, struct file* file)
 
 static ssize_t device_read(struct file* filp, char* buffer, size_t length, loff_t* offset)
 {
-    return device_read_impl(filp, buffer, length, offset, minor_number);
+    return device_read_impl(filp, buffer, length, offset);
 }
 
 static ssize_t device_write(struct file* filp, const char* buffer, size_t length, loff_t* offset)
 {
-    return device_write_impl(filp, buffer, length, offset, minor_number);
+    return device_write_impl(filp, buffer, length, offset);
+}
+
+static loff_t device_llseek(struct file* filp, loff_t offset, int whence)
+{
+    return device_llseek_impl(filp, offset, whence);
+}
+
+static long device_ioctl(struct file* file, unsigned int command, unsigned long arg)
+{
+    long result = -EINVAL;
+
+    switch (command)
+    {
+    case IOCTL_SET_PIPELINE: {
+        result = ioctl_set_pipeline(file, (const struct string_ops_pipeline*)arg);
+        break;
+    }
+    case IOCTL_GET_PIPELINE: {
+        result = ioctl_get_pipeline(file, (struct string_ops_pipeline*)arg);
+        break;
+    }
+    case IOCTL_ENABLE_STREAMING_MODE: {
+        result = ioctl_enable_streaming_mode(file, (const bool*)arg);
+        break;
+    }
+    case IOCTL_END_STREAM: {
+        result = ioctl_end_stream(file);
+        break;
+    }
+    case IOCTL_TRANSFORM_BATCH: {
+        result = ioctl_transform_batch(file, (const struct string_ops_batch*)arg);
+        break;
+    }
+    case IOCTL_RESET_MINOR_NUMBER: {
+        result = ioctl_reset_minor_number(file);
+        break;
+    }
+    default:
+        break;
+    }
+
+    return result;
 }
 
 static void do_module_cleanup(size_t existing_minor_numbers_count)
@@ -173,6 +254,7 @@ static void do_module_cleanup(size_t existing_minor_numbers_count)
 
     cdev_del(&string_ops_cdev);
     unregister_chrdev(major_number, THIS_MODULE->name);
+    free_module_data();
 }
 
 module_init(string_ops_init);
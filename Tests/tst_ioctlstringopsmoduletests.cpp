@@ -1,7 +1,15 @@
 #include <QTest>
 
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <thread>
+
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "testutils.h"
@@ -18,11 +26,25 @@
 #define IOCTL_IS_INPUT_APPEND_MODE_ENABLED _IOR(9999, 'i', bool*)
 #define IOCTL_SET_MAX_OUTPUT_SIZE _IOWR(9999, 'j', size_t*)
 #define IOCTL_GET_MAX_OUTPUT_SIZE _IOR(9999, 'k', size_t*)
+#define IOCTL_SET_CONFIG _IOW(9999, 'l', IoctlStringOpsConfig*)
+#define IOCTL_GET_STATE _IOR(9999, 'm', IoctlStringOpsState*)
+#define IOCTL_ENABLE_WAIT_FOR_DATA _IOW(9999, 'n', bool*)
+#define IOCTL_IS_WAIT_FOR_DATA_ENABLED _IOR(9999, 'o', bool*)
+#define IOCTL_ENABLE_STREAMING_MODE _IOW(9999, 'p', bool*)
+#define IOCTL_IS_STREAMING_MODE_ENABLED _IOR(9999, 'q', bool*)
+#define IOCTL_ENABLE_RECORD_MODE _IOW(9999, 'r', bool*)
+#define IOCTL_IS_RECORD_MODE_ENABLED _IOR(9999, 's', bool*)
+#define IOCTL_DEQUEUE_RECORDS _IOWR(9999, 't', IoctlStringOpsRecords*)
+#define IOCTL_SET_COMPRESSION _IOW(9999, 'u', IoctlStringOpsCompression*)
+#define IOCTL_GET_COMPRESSION_STATS _IOR(9999, 'v', IoctlStringOpsCompressionStats*)
+#define IOCTL_SET_READ_FILTER _IOW(9999, 'w', IoctlStringOpsReadFilter*)
 
 static constexpr std::string_view stringOpsModuleName{"ioctl_string_ops"};
 static constexpr std::string_view utilitiesModuleName{"kernel_utilities"};
 static constexpr std::string_view deviceDirPath{"/dev"};
 static constexpr std::string_view baseDeviceFileName{"ioctlstringops"};
+static constexpr std::string_view statsFilePath{"/sys/kernel/debug/ioctl_string_ops/stats"};
+static constexpr std::string_view hotPathLogLevelFilePath{"/sys/module/kernel_utilities/parameters/hot_path_log_level"};
 
 static constexpr size_t moduleBufferSize{1024};
 
@@ -34,6 +56,86 @@ static constexpr size_t prefixBufferSize{128};
 // size_t: size provided to the kernel module, '\0': there should be minimum one terminating character
 static constexpr size_t maxPrefixSize{prefixBufferSize - sizeof(size_t) - sizeof('\0')};
 
+// config/state structures and settings flags (should be kept in sync with the kernel module)
+static constexpr uint32_t configVersion{1};
+static constexpr uint32_t trimUserInputEnabled{0b00000001};
+static constexpr uint32_t userInputAppendingEnabled{0b00000010};
+static constexpr uint32_t waitForDataEnabled{0b00000100};
+static constexpr uint32_t streamingModeEnabled{0b00001000};
+static constexpr uint32_t recordModeEnabled{0b00010000};
+
+// default stream buffer and record queue sizes (module parameters), see kernel module
+static constexpr size_t streamBufferSize{4096};
+static constexpr size_t recordQueueSize{4096};
+
+struct IoctlStringOpsConfig
+{
+    uint32_t version;
+    uint32_t settings;
+    size_t maxOutputSize;
+    size_t outputPrefixSize;
+    const char* outputPrefix;
+};
+
+struct IoctlStringOpsState
+{
+    uint32_t version;
+    uint32_t settings;
+    size_t bufferSize;
+    size_t outputPrefixSize;
+    size_t maxOutputSize;
+    size_t charsLeftToReadCount;
+};
+
+struct IoctlStringOpsRecords
+{
+    void* buffer;
+    size_t bufferSize;
+    size_t maxRecordsCount;
+    size_t recordsCount;
+    size_t bytesCount;
+};
+
+// compression modes and structures (should be kept in sync with the kernel module)
+static constexpr uint32_t compressionModeNone{0};
+static constexpr uint32_t compressionModeLz4{1};
+static constexpr size_t maxCompressionChunkPages{16};
+
+struct IoctlStringOpsCompression
+{
+    uint32_t mode;
+    size_t chunkSize;
+};
+
+struct IoctlStringOpsCompressionStats
+{
+    uint32_t mode;
+    size_t chunkSize;
+    size_t compressedCharsCount;
+    size_t compressedSize;
+    uint32_t ratioPercent;
+};
+
+// read filter types and structure (should be kept in sync with the kernel module)
+static constexpr uint32_t readFilterNone{0};
+static constexpr uint32_t readFilterSubstring{1};
+static constexpr uint32_t readFilterGlob{2};
+static constexpr size_t maxReadFilterPatternSize{255};
+
+struct IoctlStringOpsReadFilter
+{
+    uint32_t type;
+    size_t patternSize;
+    const char* pattern;
+};
+
+// first page of the data buffer mapping (should be kept in sync with the kernel module)
+struct DataBufferHeader
+{
+    size_t head;
+    size_t tail;
+};
+
 /* These tests should be run from a terminal using sudo */
 
 class IoctlStringOpsModuleTests : public QObject
@@ -56,9 +158,30 @@ private slots:
     void testSetMaxOutputSize_FullBufferTraverseWithVariableOutputSize();
     void testSetMaxOutputSize_UseOutputPrefix();
     void testSetMaxOutputSize_UseManualOutputSizeReset();
+    void testMapDataBuffer();
+    void testSetConfigAndGetState();
+    void testWriteAndReadBinaryData();
+    void testWaitForData();
+    void testReadFromPosition();
+    void testVectoredWriteAndRead();
+    void testStreamingMode();
+    void testSpliceToAndFromPipe();
+    void testMultipleReaders();
+    void testRecordMode();
+    void testCompression();
+    void testMultipleChannels();
+    void testConsistentReadsDuringWrites();
+    void testReadFilter();
+    void testReadOutputPrefixAndDataAtBoundaries();
+    void testAppendTrimmedInputInPlace();
+    void testRaisedMaxBufferSize();
+    void testOperationStats();
+    void testHotPathLogLevel();
 
 private:
     void initializeDeviceFile();
+    void reloadKernelModule(const std::string& moduleParameters = "");
+    std::map<std::string, uint64_t> readOperationStats(); // counter name -> value
 
     bool writeToDeviceFile(const std::filesystem::path& deviceFile, const std::string& str);
     std::optional<std::string> readFromDeviceFile(const std::filesystem::path& deviceFile);
@@ -70,6 +193,16 @@ private:
     std::optional<size_t> ioctlGetOutputPrefixSize();
     void ioctlEnableInputAppendMode(bool enabled);
     bool ioctlIsInputAppendModeEnabled();
+    void ioctlEnableWaitForData(bool enabled);
+    bool ioctlIsWaitForDataEnabled();
+    void ioctlEnableStreamingMode(bool enabled);
+    bool ioctlIsStreamingModeEnabled();
+    void ioctlEnableRecordMode(bool enabled);
+    bool ioctlIsRecordModeEnabled();
+    bool ioctlDequeueRecords(IoctlStringOpsRecords& records);
+    bool ioctlSetCompression(uint32_t mode, size_t chunkSize);
+    std::optional<IoctlStringOpsCompressionStats> ioctlGetCompressionStats();
+    bool ioctlSetReadFilter(int fd, uint32_t type, const std::string& pattern); // the filter belongs to the file
 
     // value has both input and output role:
     // - input: maximum output size to be set
@@ -78,6 +211,10 @@ private:
 
     std::optional<size_t> ioctlGetMaxOutputSize();
 
+    bool ioctlSetConfig(uint32_t settings, size_t maxOutputSize, const std::string& outputPrefix,
+                        uint32_t version = configVersion);
+    std::optional<IoctlStringOpsState> ioctlGetState();
+
     void resetKernelModule();
     bool isKernelModuleReset();
 
@@ -925,199 +1062,1420 @@ void IoctlStringOpsModuleTests::testSetMaxOutputSize_UseManualOutputSizeReset()
     }
 }
 
-void IoctlStringOpsModuleTests::initializeDeviceFile()
+void IoctlStringOpsModuleTests::testMapDataBuffer()
 {
-    m_DeviceFile = deviceDirPath;
-    m_DeviceFile /= std::string{baseDeviceFileName};
+    const size_t pageSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
 
-    QVERIFY(std::filesystem::is_character_file(m_DeviceFile));
-}
+    QVERIFY(fd > 0);
 
-bool IoctlStringOpsModuleTests::writeToDeviceFile(const std::filesystem::path& deviceFile, const std::string& str)
-{
-    return Utilities::writeStringToFile(str, deviceFile, str.size());
-}
+    // writable mappings should be rejected
+    QVERIFY(mmap(nullptr, 2 * pageSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) == MAP_FAILED);
 
-std::optional<std::string> IoctlStringOpsModuleTests::readFromDeviceFile(const std::filesystem::path& deviceFile)
-{
-    return Utilities::readStringFromFile(deviceFile, maxCharsCountToRead, NON_TRIM_MODE);
-}
+    void* mappedMemory{mmap(nullptr, 2 * pageSize, PROT_READ, MAP_SHARED, fd, 0)};
+    close(fd);
 
-void IoctlStringOpsModuleTests::ioctlEnableUserInputTrimming(bool enabled)
-{
-    const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+    QVERIFY(mappedMemory != MAP_FAILED);
 
-    if (fd > 0)
-    {
-        const long retVal{ioctl(fd, IOCTL_ENABLE_USER_INPUT_TRIMMING, &enabled)};
-        close(fd);
+    const DataBufferHeader* header{static_cast<const DataBufferHeader*>(mappedMemory)};
+    const char* mappedBuffer{static_cast<const char*>(mappedMemory) + pageSize};
 
-        if (retVal != 0)
-        {
-            QFAIL("Enabling/disabling trimming failed!");
-        }
-    }
-}
+    QVERIFY(header->head == 0 && header->tail == 0);
 
-bool IoctlStringOpsModuleTests::ioctlIsUserInputTrimmingEnabled()
-{
-    bool isEnabled{false};
-    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+    writeToDeviceFile(m_DeviceFile, "1a2b3c4d5e6f7g8h");
 
-    if (fd > 0)
-    {
-        bool isTrimmingEnabled;
-        const long retVal{ioctl(fd, IOCTL_IS_USER_INPUT_TRIMMING_ENABLED, &isTrimmingEnabled)};
+    QVERIFY(header->head == 0 && header->tail == 16);
+    QVERIFY(std::string(mappedBuffer, header->tail) == "1a2b3c4d5e6f7g8h");
 
-        if (retVal == 0)
-        {
-            isEnabled = isTrimmingEnabled;
-        }
+    size_t maxOutputSize{4};
+    ioctlSetMaxOutputSize(maxOutputSize);
 
-        close(fd);
-    }
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "1a2b");
+    QVERIFY(header->head == 4 && header->tail == 16);
+    QVERIFY(std::string(mappedBuffer + header->head, header->tail - header->head) == "3c4d5e6f7g8h");
 
-    return isEnabled;
+    ioctlEnableInputAppendMode(true);
+    writeToDeviceFile(m_DeviceFile, "9i");
+
+    QVERIFY(header->head == 0 && header->tail == 18);
+    QVERIFY(std::string(mappedBuffer, header->tail) == "1a2b3c4d5e6f7g8h9i");
+
+    resetKernelModule();
+
+    QVERIFY(header->head == 0 && header->tail == 0);
+
+    // the chunks get unmapped from all device files of the channel, e.g. another device node of the same minor number
+    std::filesystem::path aliasDeviceFile{deviceDirPath};
+    aliasDeviceFile /= std::string{baseDeviceFileName} + "_alias";
+
+    QVERIFY(Utilities::createCharacterDeviceFile(aliasDeviceFile, m_MajorNumber, 0));
+
+    const int aliasFd{open(aliasDeviceFile.c_str(), O_RDONLY)};
+    std::filesystem::remove(aliasDeviceFile);
+
+    QVERIFY(aliasFd > 0);
+
+    void* aliasMappedMemory{mmap(nullptr, 2 * pageSize, PROT_READ, MAP_SHARED, aliasFd, 0)};
+    close(aliasFd);
+
+    QVERIFY(aliasMappedMemory != MAP_FAILED);
+
+    const char* aliasMappedBuffer{static_cast<const char*>(aliasMappedMemory) + pageSize};
+
+    writeToDeviceFile(m_DeviceFile, "first");
+
+    QVERIFY(std::string(aliasMappedBuffer, 5) == "first");
+
+    resetKernelModule();
+    writeToDeviceFile(m_DeviceFile, "again");
+
+    QVERIFY(std::string(aliasMappedBuffer, 5) == "again" && std::string(mappedBuffer, 5) == "again");
+
+    munmap(aliasMappedMemory, 2 * pageSize);
+    munmap(mappedMemory, 2 * pageSize);
 }
 
-std::optional<size_t> IoctlStringOpsModuleTests::ioctlGetBufferSize()
+void IoctlStringOpsModuleTests::testSetConfigAndGetState()
 {
-    std::optional<size_t> result{0};
-    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+    std::optional<IoctlStringOpsState> state{ioctlGetState()};
 
-    if (fd > 0)
-    {
-        size_t charsCountFromBuffer;
+    QVERIFY(state.has_value());
+    QVERIFY(state->version == configVersion);
+    QVERIFY(state->settings == trimUserInputEnabled);
+    QVERIFY(state->bufferSize == 0 && state->outputPrefixSize == 0);
+    QVERIFY(state->maxOutputSize == 0 && state->charsLeftToReadCount == 0);
 
-        const long retVal{ioctl(fd, IOCTL_GET_BUFFER_SIZE, (size_t*)&charsCountFromBuffer)};
+    writeToDeviceFile(m_DeviceFile, "1a2b3c4d5e6f7g8h");
 
-        if (retVal == 0)
-        {
-            result = charsCountFromBuffer;
-        }
+    QVERIFY(ioctlSetConfig(trimUserInputEnabled | userInputAppendingEnabled, 4, "Config: "));
+    QVERIFY(ioctlIsUserInputTrimmingEnabled());
+    QVERIFY(ioctlIsInputAppendModeEnabled());
+    QVERIFY(ioctlGetOutputPrefixSize() == 8);
+    QVERIFY(ioctlGetMaxOutputSize() == 4);
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "Config: 1a2b");
 
-        close(fd);
-    }
+    state = ioctlGetState();
 
-    return result;
+    QVERIFY(state.has_value());
+    QVERIFY(state->settings == (trimUserInputEnabled | userInputAppendingEnabled));
+    QVERIFY(state->bufferSize == 16 && state->outputPrefixSize == 8);
+    QVERIFY(state->maxOutputSize == 4 && state->charsLeftToReadCount == 12);
+
+    writeToDeviceFile(m_DeviceFile, " 9i ");
+
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "Config: 1a2b3c4d5e6f7g8h9i");
+
+    // invalid configs should be rejected as a whole
+    QVERIFY(!ioctlSetConfig(0, 0, "Another prefix: ", configVersion + 1));
+    QVERIFY(!ioctlSetConfig(0b10000000, 0, "Another prefix: "));
+    QVERIFY(!ioctlSetConfig(0, 0, std::string(maxPrefixSize + sizeof(size_t) + 1, 'p')));
+
+    state = ioctlGetState();
+
+    QVERIFY(state.has_value());
+    QVERIFY(state->settings == (trimUserInputEnabled | userInputAppendingEnabled));
+    QVERIFY(state->bufferSize == 18 && state->outputPrefixSize == 8);
+    QVERIFY(state->maxOutputSize == 0 && state->charsLeftToReadCount == 18);
+
+    QVERIFY(ioctlSetConfig(0, 20, ""));
+
+    state = ioctlGetState();
+
+    QVERIFY(state.has_value());
+    QVERIFY(state->settings == 0);
+    QVERIFY(state->bufferSize == 18 && state->outputPrefixSize == 0);
+    QVERIFY(state->maxOutputSize == 18 && state->charsLeftToReadCount == 18);
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "1a2b3c4d5e6f7g8h9i");
 }
 
-void IoctlStringOpsModuleTests::ioctlSetOutputPrefix(const std::string& outputPrefix)
+void IoctlStringOpsModuleTests::testWriteAndReadBinaryData()
 {
-    if (outputPrefix.size() <= maxPrefixSize)
-    {
-        const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+    using namespace std::string_literals;
 
-        if (fd > 0)
-        {
-            char data[prefixBufferSize];
-            memset(data, '\0', prefixBufferSize);
-            size_t* prefixSize{reinterpret_cast<size_t*>(data)};
-            *prefixSize = outputPrefix.size();
-            ++prefixSize;
-            char* prefix{reinterpret_cast<char*>(prefixSize)};
-            strncpy(prefix, outputPrefix.c_str(), outputPrefix.size());
-            const long retVal{ioctl(fd, IOCTL_SET_OUTPUT_PREFIX, data)};
-            close(fd);
+    const std::string binaryPrefix{"\0P\0"s};
+    const std::string binaryInput{"\0a\0b\xff\n\0"s};
 
-            if (retVal != 0)
-            {
-                QFAIL("Setting output prefix failed!");
-            }
-        }
-    }
-    else
-    {
-        assert(false);
-    }
+    QVERIFY(ioctlSetConfig(0, 0, binaryPrefix));
+    QVERIFY(ioctlGetOutputPrefixSize() == binaryPrefix.size());
+
+    int fd{open(m_DeviceFile.c_str(), O_WRONLY | O_NONBLOCK)};
+
+    QVERIFY(fd > 0);
+    QVERIFY(write(fd, binaryInput.c_str(), binaryInput.size()) == static_cast<ssize_t>(binaryInput.size()));
+
+    close(fd);
+
+    QVERIFY(ioctlGetBufferSize() == binaryInput.size());
+
+    fd = open(m_DeviceFile.c_str(), O_RDONLY | O_NONBLOCK);
+
+    QVERIFY(fd > 0);
+
+    char buffer[maxCharsCountToRead];
+    const ssize_t readCharsCount{read(fd, buffer, maxCharsCountToRead)};
+
+    close(fd);
+
+    // any '\0' chars should be part of the output, both within the prefix and the data
+    QVERIFY(readCharsCount == static_cast<ssize_t>(binaryPrefix.size() + binaryInput.size()));
+    QVERIFY(std::string(buffer, readCharsCount) == binaryPrefix + binaryInput);
 }
 
-std::optional<size_t> IoctlStringOpsModuleTests::ioctlGetOutputPrefixSize()
+void IoctlStringOpsModuleTests::testWaitForData()
 {
-    std::optional<size_t> result;
-    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+    QVERIFY(!ioctlIsWaitForDataEnabled());
 
-    if (fd > 0)
-    {
-        size_t outputPrefixSize;
-        const auto retVal{ioctl(fd, IOCTL_GET_OUTPUT_PREFIX_SIZE, (size_t*)&outputPrefixSize)};
+    writeToDeviceFile(m_DeviceFile, "1a2b3c4d");
 
-        if (retVal == 0)
-        {
-            result = outputPrefixSize;
-        }
+    // by default the end of the output is reported when reaching it
+    int fd{open(m_DeviceFile.c_str(), O_RDWR | O_NONBLOCK)};
+    char buffer[maxCharsCountToRead];
 
-        close(fd);
-    }
+    QVERIFY(fd > 0);
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 8);
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 0);
 
-    return result;
+    close(fd);
+
+    ioctlEnableInputAppendMode(true);
+    ioctlEnableWaitForData(true);
+
+    QVERIFY(ioctlIsWaitForDataEnabled());
+
+    // output read entirely: non-blocking read should fail, poll should only report the file as writable
+    fd = open(m_DeviceFile.c_str(), O_RDWR | O_NONBLOCK);
+
+    QVERIFY(fd > 0);
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 8);
+    QVERIFY(std::string(buffer, 8) == "1a2b3c4d");
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) < 0 && errno == EAGAIN);
+
+    pollfd pollFd{fd, POLLIN | POLLOUT, 0};
+
+    QVERIFY(poll(&pollFd, 1, 0) == 1);
+    QVERIFY(!(pollFd.revents & POLLIN) && (pollFd.revents & POLLOUT));
+    QVERIFY(write(fd, "5e6f", 4) == 4);
+    QVERIFY(poll(&pollFd, 1, 0) == 1);
+    QVERIFY((pollFd.revents & POLLIN) && (pollFd.revents & POLLOUT));
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 4);
+    QVERIFY(std::string(buffer, 4) == "5e6f");
+
+    close(fd);
+
+    // blocking read should wait until new data is written (same file used for reading and writing)
+    fd = open(m_DeviceFile.c_str(), O_RDWR);
+
+    QVERIFY(fd > 0);
+    QVERIFY(lseek(fd, 0, SEEK_END) == 12);
+
+    ssize_t blockingReadCharsCount{-1};
+    std::thread reader{[fd, &buffer, &blockingReadCharsCount]() {
+        blockingReadCharsCount = read(fd, buffer, maxCharsCountToRead);
+    }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+    QVERIFY(blockingReadCharsCount == -1);
+    QVERIFY(write(fd, "7g8h", 4) == 4);
+
+    reader.join();
+    close(fd);
+
+    QVERIFY(blockingReadCharsCount == 4);
+    QVERIFY(std::string(buffer, 4) == "7g8h");
+
+    resetKernelModule();
+
+    QVERIFY(!ioctlIsWaitForDataEnabled());
 }
 
-void IoctlStringOpsModuleTests::ioctlEnableInputAppendMode(bool enabled)
+void IoctlStringOpsModuleTests::testReadFromPosition()
 {
-    const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+    writeToDeviceFile(m_DeviceFile, "1a2b3c4d5e6f7g8h");
+    ioctlSetOutputPrefix("Prefix: ");
+
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY | O_NONBLOCK)};
+    char buffer[maxCharsCountToRead];
+
+    QVERIFY(fd > 0);
+
+    // the positions cover the output prefix followed by the data buffer content
+    QVERIFY(pread(fd, buffer, 6, 0) == 6);
+    QVERIFY(std::string(buffer, 6) == "Prefix");
+    QVERIFY(pread(fd, buffer, 6, 6) == 6);
+    QVERIFY(std::string(buffer, 6) == ": 1a2b");
+    QVERIFY(pread(fd, buffer, 4, 16) == 4);
+    QVERIFY(std::string(buffer, 4) == "5e6f");
+    QVERIFY(pread(fd, buffer, maxCharsCountToRead, 20) == 4);
+    QVERIFY(std::string(buffer, 4) == "7g8h");
+    QVERIFY(pread(fd, buffer, maxCharsCountToRead, 24) == 0);
+
+    // positional reads don't change the file position or the module state
+    QVERIFY(lseek(fd, 0, SEEK_CUR) == 0);
+    QVERIFY(ioctlGetMaxOutputSize() == 0);
 
-    if (fd > 0)
-    {
-        const long retVal{ioctl(fd, IOCTL_ENABLE_INPUT_APPEND_MODE, &enabled)};
-        close(fd);
+    QVERIFY(lseek(fd, -8, SEEK_END) == 16);
+    QVERIFY(read(fd, buffer, 4) == 4);
+    QVERIFY(std::string(buffer, 4) == "5e6f");
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 4);
+    QVERIFY(std::string(buffer, 4) == "7g8h");
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 0);
 
-        if (retVal != 0)
-        {
-            QFAIL("Enabling/disabling trimming failed!");
-        }
-    }
+    // seeking beyond the end of the output is not possible
+    QVERIFY(lseek(fd, 25, SEEK_SET) < 0);
+
+    close(fd);
+
+    // a maximum output size set: the shared reading cursor is used instead of the file position
+    size_t maxOutputSize{4};
+    ioctlSetMaxOutputSize(maxOutputSize);
+
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "Prefix: 1a2b");
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "Prefix: 3c4d");
 }
 
-bool IoctlStringOpsModuleTests::ioctlIsInputAppendModeEnabled()
+void IoctlStringOpsModuleTests::testVectoredWriteAndRead()
 {
-    bool isEnabled{false};
-    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+    char firstFragment[]{"  1a2b"};
+    char secondFragment[]{"3c4d"};
+    char thirdFragment[]{"5e6f  "};
 
-    if (fd > 0)
-    {
-        bool isAppendingEnabled;
-        const long retVal{ioctl(fd, IOCTL_IS_INPUT_APPEND_MODE_ENABLED, &isAppendingEnabled)};
+    // fragments are written in one go, trimming applies to the whole input (not to each fragment)
+    iovec inputFragments[]{{firstFragment, sizeof(firstFragment) - 1},
+                           {secondFragment, sizeof(secondFragment) - 1},
+                           {thirdFragment, sizeof(thirdFragment) - 1}};
 
-        if (retVal == 0)
-        {
-            isEnabled = isAppendingEnabled;
-        }
+    int fd{open(m_DeviceFile.c_str(), O_WRONLY | O_NONBLOCK)};
 
-        close(fd);
-    }
+    QVERIFY(fd > 0);
+    QVERIFY(writev(fd, inputFragments, 3) == 16);
 
-    return isEnabled;
+    close(fd);
+
+    QVERIFY(ioctlGetBufferSize() == 12);
+
+    ioctlEnableInputAppendMode(true);
+
+    fd = open(m_DeviceFile.c_str(), O_WRONLY | O_NONBLOCK);
+
+    QVERIFY(fd > 0);
+    QVERIFY(writev(fd, inputFragments + 1, 1) == 4);
+
+    close(fd);
+
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "1a2b3c4d5e6f3c4d");
+
+    // the output (prefix included) is scattered across the provided buffers in order
+    ioctlSetOutputPrefix("Output: ");
+
+    char firstOutputBuffer[5];
+    char secondOutputBuffer[64];
+    iovec outputBuffers[]{{firstOutputBuffer, sizeof(firstOutputBuffer)},
+                          {secondOutputBuffer, sizeof(secondOutputBuffer)}};
+
+    fd = open(m_DeviceFile.c_str(), O_RDONLY | O_NONBLOCK);
+
+    QVERIFY(fd > 0);
+    QVERIFY(readv(fd, outputBuffers, 2) == 24);
+
+    close(fd);
+
+    QVERIFY(std::string(firstOutputBuffer, 5) == "Outpu");
+    QVERIFY(std::string(secondOutputBuffer, 19) == "t: 1a2b3c4d5e6f3c4d");
 }
 
-bool IoctlStringOpsModuleTests::ioctlSetMaxOutputSize(size_t& value)
+void IoctlStringOpsModuleTests::testStreamingMode()
 {
-    bool success{false};
-    const int fd{open(m_DeviceFile.c_str(), O_RDWR)};
+    writeToDeviceFile(m_DeviceFile, "1a2b3c4d");
 
-    if (fd > 0)
+    QVERIFY(!ioctlIsStreamingModeEnabled());
+
+    ioctlEnableStreamingMode(true);
+
+    QVERIFY(ioctlIsStreamingModeEnabled());
+
+    // each write enqueues the chars as provided (no trimming), each read dequeues them
+    writeToDeviceFile(m_DeviceFile, " 5e6f ");
+    writeToDeviceFile(m_DeviceFile, "7g8h");
+
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == " 5e6f 7g8h");
+
+    int fd{open(m_DeviceFile.c_str(), O_RDWR | O_NONBLOCK)};
+    char buffer[maxCharsCountToRead];
+
+    QVERIFY(fd > 0);
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) < 0 && errno == EAGAIN);
+
+    pollfd pollFd{fd, POLLIN | POLLOUT, 0};
+
+    QVERIFY(poll(&pollFd, 1, 0) == 1);
+    QVERIFY(!(pollFd.revents & POLLIN) && (pollFd.revents & POLLOUT));
+
+    // the stream can only be filled up to its capacity, the chars that don't fit are not consumed
+    const std::string input(streamBufferSize + 10, 'x');
+
+    QVERIFY(write(fd, input.c_str(), input.size()) == static_cast<ssize_t>(streamBufferSize));
+    QVERIFY(write(fd, input.c_str(), input.size()) < 0 && errno == EAGAIN);
+    QVERIFY(poll(&pollFd, 1, 0) == 1);
+    QVERIFY((pollFd.revents & POLLIN) && !(pollFd.revents & POLLOUT));
+    QVERIFY(read(fd, buffer, 10) == 10);
+    QVERIFY(write(fd, "9i", 2) == 2);
+
+    const std::string expectedOutput{std::string(streamBufferSize - 10, 'x') + "9i"};
+    size_t dequeuedCharsCount{0};
+    std::string output;
+
+    while (dequeuedCharsCount < expectedOutput.size())
     {
-        size_t val{value};
-        const long retVal{ioctl(fd, IOCTL_SET_MAX_OUTPUT_SIZE, &val)};
+        const ssize_t readCharsCount{read(fd, buffer, maxCharsCountToRead)};
 
-        if (retVal == 0)
-        {
-            value = val;
-            success = true;
-        }
+        QVERIFY(readCharsCount > 0);
 
-        close(fd);
+        output.append(buffer, readCharsCount);
+        dequeuedCharsCount += readCharsCount;
     }
 
-    return success;
+    close(fd);
+
+    QVERIFY(output == expectedOutput);
+
+    // the data buffer content is kept while streaming
+    ioctlEnableStreamingMode(false);
+
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "1a2b3c4d");
+
+    // the stream is emptied when re-enabling the mode
+    ioctlEnableStreamingMode(true);
+    writeToDeviceFile(m_DeviceFile, "abcd");
+    ioctlEnableStreamingMode(false);
+    ioctlEnableStreamingMode(true);
+
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == std::nullopt);
+
+    resetKernelModule();
+
+    QVERIFY(!ioctlIsStreamingModeEnabled());
 }
 
-std::optional<size_t> IoctlStringOpsModuleTests::ioctlGetMaxOutputSize()
+void IoctlStringOpsModuleTests::testSpliceToAndFromPipe()
 {
-    std::optional<size_t> result;
-    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+    writeToDeviceFile(m_DeviceFile, "1a2b3c4d");
+    ioctlSetOutputPrefix("Output: ");
 
-    if (fd > 0)
+    int pipeFds[2];
+
+    QVERIFY(pipe(pipeFds) == 0);
+
+    const int fd{open(m_DeviceFile.c_str(), O_RDWR | O_NONBLOCK)};
+    char buffer[maxCharsCountToRead];
+
+    QVERIFY(fd > 0);
+
+    // device to pipe: the output (prefix included) is moved without passing through a user space buffer
+    QVERIFY(splice(fd, nullptr, pipeFds[1], nullptr, maxCharsCountToRead, 0) == 16);
+    QVERIFY(read(pipeFds[0], buffer, maxCharsCountToRead) == 16);
+    QVERIFY(std::string(buffer, 16) == "Output: 1a2b3c4d");
+
+    // pipe to device
+    QVERIFY(write(pipeFds[1], " 5e6f7g8h ", 10) == 10);
+    QVERIFY(splice(pipeFds[0], nullptr, fd, nullptr, 10, 0) == 10);
+
+    close(fd);
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "Output: 5e6f7g8h");
+}
+
+void IoctlStringOpsModuleTests::testMultipleReaders()
+{
+    ioctlEnableWaitForData(true);
+    ioctlEnableInputAppendMode(true);
+
+    // any number of files can be open at the same time, each one reading from its own position
+    const int writerFd{open(m_DeviceFile.c_str(), O_WRONLY)};
+    const int firstReaderFd{open(m_DeviceFile.c_str(), O_RDONLY | O_NONBLOCK)};
+    const int secondReaderFd{open(m_DeviceFile.c_str(), O_RDONLY)};
+    char firstBuffer[maxCharsCountToRead];
+    char secondBuffer[maxCharsCountToRead];
+
+    QVERIFY(writerFd > 0 && firstReaderFd > 0 && secondReaderFd > 0);
+    QVERIFY(write(writerFd, "1a2b", 4) == 4);
+    QVERIFY(read(firstReaderFd, firstBuffer, maxCharsCountToRead) == 4);
+    QVERIFY(std::string(firstBuffer, 4) == "1a2b");
+    QVERIFY(write(writerFd, "3c4d", 4) == 4);
+    QVERIFY(read(secondReaderFd, secondBuffer, maxCharsCountToRead) == 8);
+    QVERIFY(std::string(secondBuffer, 8) == "1a2b3c4d");
+    QVERIFY(read(firstReaderFd, firstBuffer, maxCharsCountToRead) == 4);
+    QVERIFY(std::string(firstBuffer, 4) == "3c4d");
+    QVERIFY(read(firstReaderFd, firstBuffer, maxCharsCountToRead) < 0 && errno == EAGAIN);
+
+    // a blocked reader is woken up by a write issued through another file
+    ssize_t blockingReadCharsCount{-1};
+    std::thread subscriber{[secondReaderFd, &secondBuffer, &blockingReadCharsCount]() {
+        blockingReadCharsCount = read(secondReaderFd, secondBuffer, maxCharsCountToRead);
+    }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+    QVERIFY(blockingReadCharsCount == -1);
+    QVERIFY(write(writerFd, "5e6f", 4) == 4);
+
+    subscriber.join();
+
+    QVERIFY(blockingReadCharsCount == 4);
+    QVERIFY(std::string(secondBuffer, 4) == "5e6f");
+
+    // once the content is replaced (no appending) each reader starts over from the beginning of the output
+    ioctlEnableInputAppendMode(false);
+
+    QVERIFY(write(writerFd, "7g8h", 4) == 4);
+    QVERIFY(read(firstReaderFd, firstBuffer, maxCharsCountToRead) == 4);
+    QVERIFY(std::string(firstBuffer, 4) == "7g8h");
+    QVERIFY(read(secondReaderFd, secondBuffer, maxCharsCountToRead) == 4);
+    QVERIFY(std::string(secondBuffer, 4) == "7g8h");
+
+    close(writerFd);
+    close(firstReaderFd);
+    close(secondReaderFd);
+}
+
+void IoctlStringOpsModuleTests::testRecordMode()
+{
+    writeToDeviceFile(m_DeviceFile, "1a2b3c4d");
+
+    QVERIFY(!ioctlIsRecordModeEnabled());
+    QVERIFY(!ioctlSetConfig(streamingModeEnabled | recordModeEnabled, 0, ""));
+
+    ioctlEnableRecordMode(true);
+
+    QVERIFY(ioctlIsRecordModeEnabled());
+
+    const int fd{open(m_DeviceFile.c_str(), O_RDWR | O_NONBLOCK)};
+    char buffer[maxCharsCountToRead];
+    bool shouldEnableStreaming{true};
+
+    QVERIFY(fd > 0);
+
+    // streaming and record mode are mutually exclusive
+    QVERIFY(ioctl(fd, IOCTL_ENABLE_STREAMING_MODE, &shouldEnableStreaming) != 0);
+    QVERIFY(!ioctlIsStreamingModeEnabled());
+
+    // each write is kept as a discrete record (no trimming), each read dequeues a whole record
+    QVERIFY(write(fd, " 5e6f ", 6) == 6);
+    QVERIFY(write(fd, "7g8h", 4) == 4);
+    QVERIFY(write(fd, "9i", 2) == 2);
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 6);
+    QVERIFY(std::string(buffer, 6) == " 5e6f ");
+
+    // the record is kept queued if it doesn't fit into the user buffer
+    QVERIFY(read(fd, buffer, 2) < 0 && errno == EMSGSIZE);
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 4);
+    QVERIFY(std::string(buffer, 4) == "7g8h");
+
+    // batch dequeue: each record is preceded by its length, only the records fitting into the buffer are dequeued
+    QVERIFY(write(fd, "0j1k", 4) == 4);
+    QVERIFY(write(fd, "2l", 2) == 2);
+
+    IoctlStringOpsRecords records{buffer, 2 * sizeof(uint16_t) + 6, 10, 0, 0};
+    uint16_t recordSize{0};
+
+    QVERIFY(ioctlDequeueRecords(records));
+    QVERIFY(records.recordsCount == 2 && records.bytesCount == 10);
+
+    memcpy(&recordSize, buffer, sizeof(uint16_t));
+
+    QVERIFY(recordSize == 2 && std::string(buffer + 2, 2) == "9i");
+
+    memcpy(&recordSize, buffer + 4, sizeof(uint16_t));
+
+    QVERIFY(recordSize == 4 && std::string(buffer + 6, 4) == "0j1k");
+
+    records = {buffer, maxCharsCountToRead, 10, 0, 0};
+
+    QVERIFY(ioctlDequeueRecords(records));
+    QVERIFY(records.recordsCount == 1 && records.bytesCount == 4);
+    QVERIFY(std::string(buffer + 2, 2) == "2l");
+    QVERIFY(ioctlDequeueRecords(records));
+    QVERIFY(records.recordsCount == 0 && records.bytesCount == 0);
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) < 0 && errno == EAGAIN);
+
+    // a record is either enqueued as a whole or not at all (its length is stored within the queue as well)
+    const std::string input(recordQueueSize, 'x');
+
+    QVERIFY(write(fd, input.c_str(), recordQueueSize) < 0 && errno == EMSGSIZE);
+    QVERIFY(write(fd, input.c_str(), recordQueueSize - sizeof(uint16_t)) ==
+            static_cast<ssize_t>(recordQueueSize - sizeof(uint16_t)));
+    QVERIFY(write(fd, "3m", 2) < 0 && errno == EAGAIN);
+
+    close(fd);
+
+    // the data buffer content is kept while in record mode
+    ioctlEnableRecordMode(false);
+
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "1a2b3c4d");
+}
+
+void IoctlStringOpsModuleTests::testCompression()
+{
+    const size_t pageSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+
+    QVERIFY(!ioctlSetCompression(compressionModeLz4 + 1, pageSize));
+    QVERIFY(!ioctlSetCompression(compressionModeLz4, 0));
+    QVERIFY(!ioctlSetCompression(compressionModeLz4, pageSize + 1));
+    QVERIFY(!ioctlSetCompression(compressionModeLz4, (maxCompressionChunkPages + 1) * pageSize));
+
+    std::optional<IoctlStringOpsCompressionStats> stats{ioctlGetCompressionStats()};
+
+    QVERIFY(stats.has_value() && stats->mode == compressionModeNone && stats->chunkSize == 0);
+
+    ioctlEnableInputAppendMode(true);
+
+    QVERIFY(ioctlSetCompression(compressionModeLz4, 2 * pageSize));
+
+    // the data buffer cannot be mapped while compression is enabled (the mapped chunks should not get released)
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    QVERIFY(fd > 0);
+    QVERIFY(mmap(nullptr, 2 * pageSize, PROT_READ, MAP_SHARED, fd, 0) == MAP_FAILED && errno == EBUSY);
+
+    // only the chunks located entirely below the data buffer length get compressed (none with the default capacity)
+    const std::string input(maxCharsCountToRead / 4, 'z');
+
+    QVERIFY(writeToDeviceFile(m_DeviceFile, input));
+    QVERIFY(writeToDeviceFile(m_DeviceFile, input));
+
+    stats = ioctlGetCompressionStats();
+
+    QVERIFY(stats.has_value() && stats->mode == compressionModeLz4 && stats->chunkSize == 2 * pageSize);
+    QVERIFY(stats->compressedCharsCount <= 2 * input.size());
+    QVERIFY(stats->compressedCharsCount == 0 || stats->ratioPercent > 100);
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == input + input);
+
+    // the content is decompressed when disabling compression
+    QVERIFY(ioctlSetCompression(compressionModeNone, 0));
+
+    stats = ioctlGetCompressionStats();
+
+    QVERIFY(stats.has_value() && stats->mode == compressionModeNone && stats->compressedCharsCount == 0);
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == input + input);
+
+    // ... and compression cannot be enabled while the data buffer is mapped
+    void* mappedMemory{mmap(nullptr, 2 * pageSize, PROT_READ, MAP_SHARED, fd, 0)};
+    close(fd);
+
+    QVERIFY(mappedMemory != MAP_FAILED);
+    QVERIFY(!ioctlSetCompression(compressionModeLz4, pageSize));
+
+    munmap(mappedMemory, 2 * pageSize);
+
+    // compression is disabled by module reset
+    QVERIFY(ioctlSetCompression(compressionModeLz4, pageSize));
+
+    resetKernelModule();
+    stats = ioctlGetCompressionStats();
+
+    QVERIFY(stats.has_value() && stats->mode == compressionModeNone);
+}
+
+void IoctlStringOpsModuleTests::testMultipleChannels()
+{
+    std::filesystem::path secondDeviceFile{m_DeviceFile};
+    secondDeviceFile += "1";
+
+    if (!std::filesystem::is_character_file(secondDeviceFile))
+    {
+        QSKIP("The module should be loaded with channels_count=2 (or higher)");
+    }
+
+    // each channel (minor number) has its own data buffer and settings
+    ioctlEnableInputAppendMode(true);
+
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "first"));
+    QVERIFY(writeToDeviceFile(secondDeviceFile, "second"));
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "First"));
+    QVERIFY(writeToDeviceFile(secondDeviceFile, "Second"));
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "firstFirst");
+    QVERIFY(readFromDeviceFile(secondDeviceFile) == "Second");
+
+    // resetting a channel doesn't affect the other ones
+    resetKernelModule();
+
+    QVERIFY(readFromDeviceFile(secondDeviceFile) == "Second");
+
+    const int fd{open(secondDeviceFile.c_str(), O_RDONLY)};
+
+    QVERIFY(fd > 0);
+    QVERIFY(ioctl(fd, IOCTL_DO_MODULE_RESET, nullptr) == 0);
+
+    close(fd);
+
+    QVERIFY(readFromDeviceFile(secondDeviceFile) == "");
+}
+
+void IoctlStringOpsModuleTests::testConsistentReadsDuringWrites()
+{
+    constexpr size_t contentSize{maxCharsCountToRead - 1};
+    constexpr int writesCount{2000};
+
+    const int writerFd{open(m_DeviceFile.c_str(), O_WRONLY)};
+    const int readerFd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    QVERIFY(writerFd > 0 && readerFd > 0);
+    QVERIFY(write(writerFd, std::string(contentSize, 'a').c_str(), contentSize) == static_cast<ssize_t>(contentSize));
+
+    // each write replaces the whole content with a single repeated char, a reader should never see a mix of two writes
+    std::thread writer{[writerFd]() {
+        for (int writeIndex = 0; writeIndex < writesCount; ++writeIndex)
+        {
+            const std::string content(contentSize, static_cast<char>('a' + writeIndex % 26));
+
+            if (write(writerFd, content.c_str(), contentSize) != static_cast<ssize_t>(contentSize))
+            {
+                break;
+            }
+        }
+    }};
+
+    char buffer[maxCharsCountToRead];
+    bool isConsistent{true};
+
+    for (int readIndex = 0; readIndex < writesCount && isConsistent; ++readIndex)
+    {
+        const ssize_t readCharsCount{pread(readerFd, buffer, maxCharsCountToRead, 0)};
+
+        isConsistent = readCharsCount == static_cast<ssize_t>(contentSize) &&
+                       std::all_of(buffer, buffer + contentSize, [&buffer](char ch) { return ch == buffer[0]; });
+    }
+
+    writer.join();
+
+    QVERIFY(isConsistent);
+
+    close(writerFd);
+    close(readerFd);
+}
+
+void IoctlStringOpsModuleTests::testReadFilter()
+{
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "alpha\nbeta\ngamma\nalphabet"));
+
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+    char buffer[maxCharsCountToRead];
+
+    QVERIFY(fd > 0);
+
+    // invalid filters are rejected
+    QVERIFY(!ioctlSetReadFilter(fd, readFilterGlob + 1, "alpha"));
+    QVERIFY(!ioctlSetReadFilter(fd, readFilterSubstring, std::string(maxReadFilterPatternSize + 1, 'a')));
+    QVERIFY(!ioctlSetReadFilter(fd, readFilterGlob, std::string{"al\0pha", 6}));
+
+    // only the matching lines are read, the last line doesn't require a terminating '\n'
+    QVERIFY(ioctlSetReadFilter(fd, readFilterSubstring, "alpha"));
+
+    ssize_t readCharsCount{pread(fd, buffer, maxCharsCountToRead, 0)};
+
+    QVERIFY(readCharsCount > 0 && std::string(buffer, readCharsCount) == "alpha\nalphabet");
+
+    // glob patterns match whole lines
+    QVERIFY(ioctlSetReadFilter(fd, readFilterGlob, "?eta"));
+
+    readCharsCount = pread(fd, buffer, maxCharsCountToRead, 0);
+
+    QVERIFY(readCharsCount > 0 && std::string(buffer, readCharsCount) == "beta\n");
+
+    // whole lines are read, except for a line not fitting into the user buffer at all (continued by the next read)
+    QVERIFY(ioctlSetReadFilter(fd, readFilterSubstring, "a"));
+
+    readCharsCount = read(fd, buffer, 8);
+
+    QVERIFY(readCharsCount > 0 && std::string(buffer, readCharsCount) == "alpha\n");
+
+    readCharsCount = read(fd, buffer, 3);
+
+    QVERIFY(readCharsCount > 0 && std::string(buffer, readCharsCount) == "bet");
+
+    readCharsCount = read(fd, buffer, 8);
+
+    QVERIFY(readCharsCount > 0 && std::string(buffer, readCharsCount) == "a\ngamma\n");
+
+    readCharsCount = read(fd, buffer, maxCharsCountToRead);
+
+    QVERIFY(readCharsCount > 0 && std::string(buffer, readCharsCount) == "alphabet");
+    QVERIFY(read(fd, buffer, maxCharsCountToRead) == 0);
+
+    // the filter of a file doesn't apply to the other files
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "alpha\nbeta\ngamma\nalphabet");
+
+    // no filter: the whole output is read again
+    QVERIFY(ioctlSetReadFilter(fd, readFilterNone, ""));
+
+    readCharsCount = pread(fd, buffer, maxCharsCountToRead, 0);
+
+    QVERIFY(readCharsCount > 0 && std::string(buffer, readCharsCount) == "alpha\nbeta\ngamma\nalphabet");
+
+    close(fd);
+}
+
+void IoctlStringOpsModuleTests::testReadOutputPrefixAndDataAtBoundaries()
+{
+    const std::string outputPrefix(maxPrefixSize, '>');
+    std::string data(maxCharsCountToRead, '\0');
+
+    for (size_t index = 0; index < data.size(); ++index)
+    {
+        data[index] = static_cast<char>('a' + index % 26);
+    }
+
+    QVERIFY(writeToDeviceFile(m_DeviceFile, data));
+
+    ioctlSetOutputPrefix(outputPrefix);
+
+    const std::string output{outputPrefix + data};
+    const size_t prefixSize{outputPrefix.size()};
+    std::string buffer(output.size() + 1, '\0');
+    int fd{open(m_DeviceFile.c_str(), O_RDONLY | O_NONBLOCK)};
+
+    QVERIFY(fd > 0);
+
+    // both segments (full prefix and full data buffer) are read at once
+    QVERIFY(pread(fd, buffer.data(), buffer.size(), 0) == static_cast<ssize_t>(output.size()));
+    QVERIFY(buffer.compare(0, output.size(), output) == 0);
+
+    // prefix only, then one char on each side of the boundary between the segments
+    QVERIFY(pread(fd, buffer.data(), prefixSize, 0) == static_cast<ssize_t>(prefixSize));
+    QVERIFY(buffer.compare(0, prefixSize, outputPrefix) == 0);
+    QVERIFY(pread(fd, buffer.data(), 2, prefixSize - 1) == 2);
+    QVERIFY(buffer.compare(0, 2, output, prefixSize - 1, 2) == 0);
+
+    // data buffer only, up to its last char and beyond its end
+    QVERIFY(pread(fd, buffer.data(), buffer.size(), prefixSize) == static_cast<ssize_t>(data.size()));
+    QVERIFY(buffer.compare(0, data.size(), data) == 0);
+    QVERIFY(pread(fd, buffer.data(), buffer.size(), output.size() - 1) == 1);
+    QVERIFY(buffer[0] == data.back());
+    QVERIFY(pread(fd, buffer.data(), buffer.size(), output.size()) == 0);
+
+    // reads shorter than the prefix: the boundary between the segments falls inside one of them
+    std::string reconstructedOutput;
+    ssize_t readCharsCount;
+
+    while ((readCharsCount = read(fd, buffer.data(), prefixSize - 1)) > 0)
+    {
+        reconstructedOutput.append(buffer.data(), readCharsCount);
+    }
+
+    QVERIFY(readCharsCount == 0);
+    QVERIFY(reconstructedOutput == output);
+
+    close(fd);
+
+    // a maximum output size set: each read contains the full prefix followed by the next data segment
+    size_t maxOutputSize{data.size() - 1};
+    ioctlSetMaxOutputSize(maxOutputSize);
+
+    QVERIFY(Utilities::readStringFromFile(m_DeviceFile, buffer.size(), NON_TRIM_MODE) ==
+            outputPrefix + data.substr(0, data.size() - 1));
+    QVERIFY(Utilities::readStringFromFile(m_DeviceFile, buffer.size(), NON_TRIM_MODE) ==
+            outputPrefix + data.substr(data.size() - 1));
+
+    // a read ending exactly at the end of the prefix doesn't consume any data buffer chars
+    maxOutputSize = 1;
+    ioctlSetMaxOutputSize(maxOutputSize);
+    fd = open(m_DeviceFile.c_str(), O_RDONLY | O_NONBLOCK);
+
+    QVERIFY(fd > 0);
+    QVERIFY(read(fd, buffer.data(), prefixSize) == static_cast<ssize_t>(prefixSize));
+    QVERIFY(buffer.compare(0, prefixSize, outputPrefix) == 0);
+
+    close(fd);
+
+    QVERIFY(ioctlSetMaxOutputSize(maxOutputSize));
+    QVERIFY(maxOutputSize == data.size());
+}
+
+void IoctlStringOpsModuleTests::testAppendTrimmedInputInPlace()
+{
+    const size_t pageSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    QVERIFY(fd > 0);
+
+    void* mappedMemory{mmap(nullptr, 2 * pageSize, PROT_READ, MAP_SHARED, fd, 0)};
+    close(fd);
+
+    QVERIFY(mappedMemory != MAP_FAILED);
+
+    const DataBufferHeader* header{static_cast<const DataBufferHeader*>(mappedMemory)};
+    const char* mappedBuffer{static_cast<const char*>(mappedMemory) + pageSize};
+
+    ioctlEnableInputAppendMode(true);
+
+    // each input gets trimmed on its own, the remaining chars are stored right after the existing content
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "  1a2b  "));
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "\t3c4d\n"));
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "    "));
+
+    QVERIFY(header->tail == 8);
+    QVERIFY(std::string(mappedBuffer, header->tail) == "1a2b3c4d");
+
+    // the space taken by the leading whitespaces while copying is refilled from the remaining input
+    const std::string filler(maxCharsCountToRead - 13, 'a');
+
+    QVERIFY(writeToDeviceFile(m_DeviceFile, filler));
+    QVERIFY(ioctlGetBufferSize() == maxCharsCountToRead - 5);
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "     5e6f7"));
+    QVERIFY(ioctlGetBufferSize() == maxCharsCountToRead);
+    QVERIFY(header->tail == maxCharsCountToRead);
+    QVERIFY(std::string(mappedBuffer, header->tail) == "1a2b3c4d" + filler + "5e6f7");
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "1a2b3c4d" + filler + "5e6f7");
+
+    // a full buffer doesn't accept any further chars
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "  g8h"));
+    QVERIFY(ioctlGetBufferSize() == maxCharsCountToRead);
+
+    // truncated input: the trailing whitespaces of the stored chars are kept (they are not trailing within the input)
+    ioctlEnableInputAppendMode(false);
+
+    QVERIFY(writeToDeviceFile(m_DeviceFile, filler + "1a2b3c4d5e"));
+
+    ioctlEnableInputAppendMode(true);
+
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "  g8 h9  "));
+    QVERIFY(ioctlGetBufferSize() == maxCharsCountToRead);
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == filler + "1a2b3c4d5eg8 ");
+
+    munmap(mappedMemory, 2 * pageSize);
+}
+
+void IoctlStringOpsModuleTests::testRaisedMaxBufferSize()
+{
+    const size_t pageSize{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+
+    // several page sized chunks, the last one partially used
+    const size_t raisedMaxBufferSize{2 * pageSize + pageSize / 2};
+    const size_t appendedCharsCount{raisedMaxBufferSize / 4};
+
+    reloadKernelModule("max_buffer_size=" + std::to_string(raisedMaxBufferSize));
+
+    std::string content(raisedMaxBufferSize, '\0');
+
+    for (size_t index = 0; index < content.size(); ++index)
+    {
+        content[index] = static_cast<char>('a' + index % 26);
+    }
+
+    // the content grows beyond the default capacity (1023 chars) without getting truncated
+    ioctlEnableInputAppendMode(true);
+
+    for (size_t index = 0; index < content.size(); index += appendedCharsCount)
+    {
+        QVERIFY(writeToDeviceFile(m_DeviceFile, content.substr(index, appendedCharsCount)));
+    }
+
+    QVERIFY(ioctlGetBufferSize() == raisedMaxBufferSize);
+    QVERIFY(Utilities::readStringFromFile(m_DeviceFile, raisedMaxBufferSize + 1, NON_TRIM_MODE) == content);
+
+    // the raised capacity is still an upper limit
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "z"));
+    QVERIFY(ioctlGetBufferSize() == raisedMaxBufferSize);
+
+    ioctlEnableInputAppendMode(false);
+
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "z" + content));
+    QVERIFY(ioctlGetBufferSize() == raisedMaxBufferSize);
+    QVERIFY(Utilities::readStringFromFile(m_DeviceFile, raisedMaxBufferSize + 1, NON_TRIM_MODE) ==
+            "z" + content.substr(0, raisedMaxBufferSize - 1));
+
+    // the chars stored on both sides of a chunk boundary are read together
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY | O_NONBLOCK)};
+    char buffer[2];
+
+    QVERIFY(fd > 0);
+    QVERIFY(pread(fd, buffer, 2, pageSize - 1) == 2);
+    QVERIFY(std::string(buffer, 2) == content.substr(pageSize - 2, 2));
+
+    close(fd);
+
+    // back to the default module parameters for the other tests
+    reloadKernelModule();
+}
+
+void IoctlStringOpsModuleTests::testOperationStats()
+{
+    if (!std::filesystem::exists(statsFilePath))
+    {
+        QSKIP("The debugfs file system should be mounted (/sys/kernel/debug)");
+    }
+
+    ioctlSetOutputPrefix("Prefix: ");
+
+    const int fd{open(m_DeviceFile.c_str(), O_RDWR | O_NONBLOCK)};
+    const std::string input(maxCharsCountToRead, 'a');
+    char buffer[maxCharsCountToRead];
+
+    QVERIFY(fd > 0);
+
+    // the counters are shared by all channels and never reset, only their increase is checked
+    std::map<std::string, uint64_t> initialStats{readOperationStats()};
+
+    QVERIFY(initialStats.size() > 0);
+    QVERIFY(write(fd, "1a2b3c4d", 8) == 8);
+    QVERIFY(pread(fd, buffer, maxCharsCountToRead, 0) == 16);
+    QVERIFY(pread(fd, buffer, 4, 8) == 4);
+
+    ioctlEnableInputAppendMode(true);
+
+    // the data buffer is already partially filled, so the appended input gets truncated
+    QVERIFY(write(fd, input.c_str(), input.size()) == static_cast<ssize_t>(input.size()));
+
+    (void)ioctl(fd, _IO(9999, 0), nullptr);
+
+    close(fd);
+
+    std::map<std::string, uint64_t> stats{readOperationStats()};
+
+    QVERIFY(stats["reads"] - initialStats["reads"] == 2);
+    QVERIFY(stats["writes"] - initialStats["writes"] == 2);
+    QVERIFY(stats["bytes_out"] - initialStats["bytes_out"] == 20);
+    QVERIFY(stats["bytes_in"] - initialStats["bytes_in"] == 8 + input.size());
+    QVERIFY(stats["truncated_writes"] - initialStats["truncated_writes"] == 1);
+    QVERIFY(stats["prefixed_reads"] - initialStats["prefixed_reads"] == 1);
+    QVERIFY(stats["ioctl_h"] - initialStats["ioctl_h"] == 1);
+    QVERIFY(stats["ioctl_unknown"] - initialStats["ioctl_unknown"] == 1);
+}
+
+void IoctlStringOpsModuleTests::testHotPathLogLevel()
+{
+    const std::optional<int> initialLogLevel{Utilities::readIntValueFromFile(hotPathLogLevelFilePath)};
+
+    QVERIFY(initialLogLevel.has_value());
+
+    // off (0), info (1) and debug (2) are the valid levels
+    for (const int logLevel : {2, 0, 1})
+    {
+        const std::string value{std::to_string(logLevel)};
+
+        QVERIFY(Utilities::writeStringToFile(value, hotPathLogLevelFilePath, value.size()));
+        QVERIFY(Utilities::readIntValueFromFile(hotPathLogLevelFilePath) == logLevel);
+    }
+
+    // any other value is rejected and the current level is kept
+    for (const std::string value : {"3", "-1", "10", "debug"})
+    {
+        QVERIFY(!Utilities::writeStringToFile(value, hotPathLogLevelFilePath, value.size()));
+        QVERIFY(Utilities::readIntValueFromFile(hotPathLogLevelFilePath) == 1);
+    }
+
+    // the module keeps working with the level changed at runtime
+    QVERIFY(writeToDeviceFile(m_DeviceFile, "1a2b3c4d"));
+    QVERIFY(readFromDeviceFile(m_DeviceFile) == "1a2b3c4d");
+
+    const std::string initialValue{std::to_string(*initialLogLevel)};
+
+    QVERIFY(Utilities::writeStringToFile(initialValue, hotPathLogLevelFilePath, initialValue.size()));
+}
+
+void IoctlStringOpsModuleTests::initializeDeviceFile()
+{
+    m_DeviceFile = deviceDirPath;
+    m_DeviceFile /= std::string{baseDeviceFileName};
+
+    QVERIFY(std::filesystem::is_character_file(m_DeviceFile));
+}
+
+void IoctlStringOpsModuleTests::reloadKernelModule(const std::string& moduleParameters)
+{
+    try
+    {
+        const auto stringOpsModulePath{Utilities::Test::getModulePath(stringOpsModuleName)};
+        QVERIFY(stringOpsModulePath.has_value());
+
+        Utilities::unloadKernelModule(stringOpsModuleName);
+        Utilities::loadKernelModule(*stringOpsModulePath, moduleParameters);
+
+        QVERIFY(Utilities::isKernelModuleLoaded(stringOpsModuleName));
+
+        m_MajorNumber = Utilities::getMajorDriverNumber(stringOpsModuleName);
+        QVERIFY(m_MajorNumber > 0);
+
+        initializeDeviceFile();
+    }
+    catch (const std::runtime_error& err)
+    {
+        QFAIL(err.what());
+    }
+}
+
+std::map<std::string, uint64_t> IoctlStringOpsModuleTests::readOperationStats()
+{
+    std::map<std::string, uint64_t> stats;
+    std::ifstream statsFile{std::string{statsFilePath}};
+    std::string name;
+    uint64_t value;
+
+    // one counter per line: "<name>: <value>"
+    while (statsFile >> name >> value)
+    {
+        name.pop_back();
+        stats[name] = value;
+    }
+
+    return stats;
+}
+
+bool IoctlStringOpsModuleTests::writeToDeviceFile(const std::filesystem::path& deviceFile, const std::string& str)
+{
+    return Utilities::writeStringToFile(str, deviceFile, str.size());
+}
+
+std::optional<std::string> IoctlStringOpsModuleTests::readFromDeviceFile(const std::filesystem::path& deviceFile)
+{
+    return Utilities::readStringFromFile(deviceFile, maxCharsCountToRead, NON_TRIM_MODE);
+}
+
+void IoctlStringOpsModuleTests::ioctlEnableUserInputTrimming(bool enabled)
+{
+    const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+
+    if (fd > 0)
+    {
+        const long retVal{ioctl(fd, IOCTL_ENABLE_USER_INPUT_TRIMMING, &enabled)};
+        close(fd);
+
+        if (retVal != 0)
+        {
+            QFAIL("Enabling/disabling trimming failed!");
+        }
+    }
+}
+
+bool IoctlStringOpsModuleTests::ioctlIsUserInputTrimmingEnabled()
+{
+    bool isEnabled{false};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        bool isTrimmingEnabled;
+        const long retVal{ioctl(fd, IOCTL_IS_USER_INPUT_TRIMMING_ENABLED, &isTrimmingEnabled)};
+
+        if (retVal == 0)
+        {
+            isEnabled = isTrimmingEnabled;
+        }
+
+        close(fd);
+    }
+
+    return isEnabled;
+}
+
+std::optional<size_t> IoctlStringOpsModuleTests::ioctlGetBufferSize()
+{
+    std::optional<size_t> result{0};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        size_t charsCountFromBuffer;
+
+        const long retVal{ioctl(fd, IOCTL_GET_BUFFER_SIZE, (size_t*)&charsCountFromBuffer)};
+
+        if (retVal == 0)
+        {
+            result = charsCountFromBuffer;
+        }
+
+        close(fd);
+    }
+
+    return result;
+}
+
+void IoctlStringOpsModuleTests::ioctlSetOutputPrefix(const std::string& outputPrefix)
+{
+    if (outputPrefix.size() <= maxPrefixSize)
+    {
+        const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+
+        if (fd > 0)
+        {
+            char data[prefixBufferSize];
+            memset(data, '\0', prefixBufferSize);
+            size_t* prefixSize{reinterpret_cast<size_t*>(data)};
+            *prefixSize = outputPrefix.size();
+            ++prefixSize;
+            char* prefix{reinterpret_cast<char*>(prefixSize)};
+            strncpy(prefix, outputPrefix.c_str(), outputPrefix.size());
+            const long retVal{ioctl(fd, IOCTL_SET_OUTPUT_PREFIX, data)};
+            close(fd);
+
+            if (retVal != 0)
+            {
+                QFAIL("Setting output prefix failed!");
+            }
+        }
+    }
+    else
+    {
+        assert(false);
+    }
+}
+
+std::optional<size_t> IoctlStringOpsModuleTests::ioctlGetOutputPrefixSize()
+{
+    std::optional<size_t> result;
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        size_t outputPrefixSize;
+        const auto retVal{ioctl(fd, IOCTL_GET_OUTPUT_PREFIX_SIZE, (size_t*)&outputPrefixSize)};
+
+        if (retVal == 0)
+        {
+            result = outputPrefixSize;
+        }
+
+        close(fd);
+    }
+
+    return result;
+}
+
+void IoctlStringOpsModuleTests::ioctlEnableInputAppendMode(bool enabled)
+{
+    const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+
+    if (fd > 0)
+    {
+        const long retVal{ioctl(fd, IOCTL_ENABLE_INPUT_APPEND_MODE, &enabled)};
+        close(fd);
+
+        if (retVal != 0)
+        {
+            QFAIL("Enabling/disabling trimming failed!");
+        }
+    }
+}
+
+bool IoctlStringOpsModuleTests::ioctlIsInputAppendModeEnabled()
+{
+    bool isEnabled{false};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        bool isAppendingEnabled;
+        const long retVal{ioctl(fd, IOCTL_IS_INPUT_APPEND_MODE_ENABLED, &isAppendingEnabled)};
+
+        if (retVal == 0)
+        {
+            isEnabled = isAppendingEnabled;
+        }
+
+        close(fd);
+    }
+
+    return isEnabled;
+}
+
+void IoctlStringOpsModuleTests::ioctlEnableWaitForData(bool enabled)
+{
+    const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+
+    if (fd > 0)
+    {
+        const long retVal{ioctl(fd, IOCTL_ENABLE_WAIT_FOR_DATA, &enabled)};
+        close(fd);
+
+        if (retVal != 0)
+        {
+            QFAIL("Enabling/disabling waiting for data failed!");
+        }
+    }
+}
+
+bool IoctlStringOpsModuleTests::ioctlIsWaitForDataEnabled()
+{
+    bool isEnabled{false};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        bool isWaitingEnabled;
+        const long retVal{ioctl(fd, IOCTL_IS_WAIT_FOR_DATA_ENABLED, &isWaitingEnabled)};
+
+        if (retVal == 0)
+        {
+            isEnabled = isWaitingEnabled;
+        }
+
+        close(fd);
+    }
+
+    return isEnabled;
+}
+
+void IoctlStringOpsModuleTests::ioctlEnableStreamingMode(bool enabled)
+{
+    const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+
+    if (fd > 0)
+    {
+        const long retVal{ioctl(fd, IOCTL_ENABLE_STREAMING_MODE, &enabled)};
+        close(fd);
+
+        if (retVal != 0)
+        {
+            QFAIL("Enabling/disabling streaming mode failed!");
+        }
+    }
+}
+
+bool IoctlStringOpsModuleTests::ioctlIsStreamingModeEnabled()
+{
+    bool isEnabled{false};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        bool isStreamingEnabled;
+        const long retVal{ioctl(fd, IOCTL_IS_STREAMING_MODE_ENABLED, &isStreamingEnabled)};
+
+        if (retVal == 0)
+        {
+            isEnabled = isStreamingEnabled;
+        }
+
+        close(fd);
+    }
+
+    return isEnabled;
+}
+
+void IoctlStringOpsModuleTests::ioctlEnableRecordMode(bool enabled)
+{
+    const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+
+    if (fd > 0)
+    {
+        const long retVal{ioctl(fd, IOCTL_ENABLE_RECORD_MODE, &enabled)};
+        close(fd);
+
+        if (retVal != 0)
+        {
+            QFAIL("Enabling/disabling record mode failed!");
+        }
+    }
+}
+
+bool IoctlStringOpsModuleTests::ioctlIsRecordModeEnabled()
+{
+    bool isEnabled{false};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        bool isRecordModeEnabled;
+        const long retVal{ioctl(fd, IOCTL_IS_RECORD_MODE_ENABLED, &isRecordModeEnabled)};
+
+        if (retVal == 0)
+        {
+            isEnabled = isRecordModeEnabled;
+        }
+
+        close(fd);
+    }
+
+    return isEnabled;
+}
+
+bool IoctlStringOpsModuleTests::ioctlDequeueRecords(IoctlStringOpsRecords& records)
+{
+    bool success{false};
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        success = ioctl(fd, IOCTL_DEQUEUE_RECORDS, &records) == 0;
+        close(fd);
+    }
+
+    return success;
+}
+
+bool IoctlStringOpsModuleTests::ioctlSetCompression(uint32_t mode, size_t chunkSize)
+{
+    bool success{false};
+    const int fd{open(m_DeviceFile.c_str(), O_RDWR)};
+
+    if (fd > 0)
+    {
+        const IoctlStringOpsCompression compression{mode, chunkSize};
+
+        success = ioctl(fd, IOCTL_SET_COMPRESSION, &compression) == 0;
+        close(fd);
+    }
+
+    return success;
+}
+
+std::optional<IoctlStringOpsCompressionStats> IoctlStringOpsModuleTests::ioctlGetCompressionStats()
+{
+    std::optional<IoctlStringOpsCompressionStats> result;
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        IoctlStringOpsCompressionStats stats{};
+
+        if (ioctl(fd, IOCTL_GET_COMPRESSION_STATS, &stats) == 0)
+        {
+            result = stats;
+        }
+
+        close(fd);
+    }
+
+    return result;
+}
+
+bool IoctlStringOpsModuleTests::ioctlSetReadFilter(int fd, uint32_t type, const std::string& pattern)
+{
+    const IoctlStringOpsReadFilter readFilter{type, pattern.size(), pattern.c_str()};
+
+    return ioctl(fd, IOCTL_SET_READ_FILTER, &readFilter) == 0;
+}
+
+bool IoctlStringOpsModuleTests::ioctlSetMaxOutputSize(size_t& value)
+{
+    bool success{false};
+    const int fd{open(m_DeviceFile.c_str(), O_RDWR)};
+
+    if (fd > 0)
+    {
+        size_t val{value};
+        const long retVal{ioctl(fd, IOCTL_SET_MAX_OUTPUT_SIZE, &val)};
+
+        if (retVal == 0)
+        {
+            value = val;
+            success = true;
+        }
+
+        close(fd);
+    }
+
+    return success;
+}
+
+std::optional<size_t> IoctlStringOpsModuleTests::ioctlGetMaxOutputSize()
+{
+    std::optional<size_t> result;
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
     {
         size_t maxOutputSize;
         const auto retVal{ioctl(fd, IOCTL_GET_MAX_OUTPUT_SIZE, (size_t*)&maxOutputSize)};
@@ -1133,6 +2491,45 @@ std::optional<size_t> IoctlStringOpsModuleTests::ioctlGetMaxOutputSize()
     return result;
 }
 
+bool IoctlStringOpsModuleTests::ioctlSetConfig(uint32_t settings, size_t maxOutputSize, const std::string& outputPrefix,
+                                               uint32_t version)
+{
+    bool success{false};
+    const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
+
+    if (fd > 0)
+    {
+        const IoctlStringOpsConfig config{version, settings, maxOutputSize, outputPrefix.size(), outputPrefix.c_str()};
+        const long retVal{ioctl(fd, IOCTL_SET_CONFIG, &config)};
+
+        success = retVal == 0;
+        close(fd);
+    }
+
+    return success;
+}
+
+std::optional<IoctlStringOpsState> IoctlStringOpsModuleTests::ioctlGetState()
+{
+    std::optional<IoctlStringOpsState> result;
+    const int fd{open(m_DeviceFile.c_str(), O_RDONLY)};
+
+    if (fd > 0)
+    {
+        IoctlStringOpsState state;
+        const long retVal{ioctl(fd, IOCTL_GET_STATE, &state)};
+
+        if (retVal == 0)
+        {
+            result = state;
+        }
+
+        close(fd);
+    }
+
+    return result;
+}
+
 void IoctlStringOpsModuleTests::resetKernelModule()
 {
     const int fd{open(m_DeviceFile.c_str(), O_WRONLY)};
@@ -1,5 +1,12 @@
 #include <QTest>
 
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
 #include "testutils.h"
 #include "utils.h"
 
@@ -12,6 +19,50 @@ static constexpr int unsupportedMinorNumber{4};
 
 static constexpr size_t maxCharsCountToRead{255};
 
+// pipeline operations and structure (should be kept in sync with the kernel module)
+static constexpr uint8_t pipelineOpTrim{1};
+static constexpr uint8_t pipelineOpToLowerCase{2};
+static constexpr uint8_t pipelineOpToUpperCase{3};
+static constexpr uint8_t pipelineOpReverse{4};
+static constexpr uint8_t pipelineOpAppendLength{5};
+static constexpr size_t maxPipelineOpsCount{8};
+
+struct StringOpsPipeline
+{
+    uint32_t opsCount;
+    uint8_t ops[maxPipelineOpsCount];
+};
+
+// batch items and structure (should be kept in sync with the kernel module)
+struct StringOpsBatchItem
+{
+    const char* input;
+    size_t inputLength;
+    char* output;
+    size_t outputCapacity;
+    size_t outputLength;
+    int32_t status;
+};
+
+struct StringOpsBatch
+{
+    StringOpsBatchItem* items;
+    uint32_t itemsCount;
+};
+
+#define IOCTL_SET_PIPELINE _IOW(9999, 'a', StringOpsPipeline*)
+#define IOCTL_GET_PIPELINE _IOR(9999, 'b', StringOpsPipeline*)
+#define IOCTL_ENABLE_STREAMING_MODE _IOW(9999, 'c', bool*)
+#define IOCTL_END_STREAM _IOW(9999, 'd', void*)
+#define IOCTL_TRANSFORM_BATCH _IOWR(9999, 'e', StringOpsBatch*)
+#define IOCTL_RESET_MINOR_NUMBER _IOW(9999, 'f', void*)
+
+// default stream buffer size (module parameter), see kernel module
+static constexpr size_t streamBufferSize{16384};
+
+// default input buffer size (module parameter), terminating '\0' included
+static constexpr size_t inputBufferSize{128};
+
 /* These tests should be run from a terminal using sudo */
 
 class StringOpsModuleTests : public QObject
@@ -31,7 +82,13 @@ private slots:
     void testReadFromAfterWriteToMinorNumber1();
     void testReadFromAfterWriteToMinorNumber2();
     void testReadFromAfterWriteToMinorNumber3();
+    void testWordAtATimeTransforms();
     void testCombinedReadFromAfterWriteTo();
+    void testConcurrentlyOpenedDeviceFiles();
+    void testPipelines();
+    void testStreamingMode();
+    void testBatchTransform();
+    void testResetMinorNumber();
 
 private:
     void initializeSupportedMinorNumbers();
@@ -40,6 +97,7 @@ private:
 
     bool writeToDeviceFile(const std::filesystem::path& deviceFile, const std::string& str);
     std::optional<std::string> readFromDeviceFile(const std::filesystem::path& deviceFile);
+    bool ioctlResetMinorNumber(const std::filesystem::path& deviceFile);
 
     void resetKernelModule();
     bool isKernelModuleReset();
@@ -257,6 +315,52 @@ void StringOpsModuleTests::testReadFromAfterWriteToMinorNumber3()
     QVERIFY("12A-bCd_EF+" == readFromDeviceFile(m_DeviceFileMinor0));
 }
 
+void StringOpsModuleTests::testWordAtATimeTransforms()
+{
+    // the chars are converted/reversed 8 at a time, the remaining ones (odd tail) one by one
+    const std::string boundaryChars{"@AZ[`az{"};
+    const std::string longInput{"ABCDEFGHIJKLMNOPQRSTUVWXYZ @[`{ abcdefghijklmnopqrstuvwxyz 0123456789!?"};
+
+    // the words containing non-ASCII chars are converted char by char, the non-ASCII chars are kept as they are
+    const std::string nonAsciiInput{"AB\x80"
+                                    "CD\xA9"
+                                    "EFGHIJKLMN\xBF"
+                                    "Q"};
+
+    writeToDeviceFile(m_DeviceFileMinor1, boundaryChars);
+
+    QVERIFY("@az[`az{" == readFromDeviceFile(m_DeviceFileMinor1));
+
+    writeToDeviceFile(m_DeviceFileMinor1, longInput);
+
+    QVERIFY("abcdefghijklmnopqrstuvwxyz @[`{ abcdefghijklmnopqrstuvwxyz 0123456789!?" ==
+            readFromDeviceFile(m_DeviceFileMinor1));
+
+    writeToDeviceFile(m_DeviceFileMinor1, nonAsciiInput);
+
+    QVERIFY("ab\x80"
+            "cd\xA9"
+            "efghijklmn\xBF"
+            "q" == readFromDeviceFile(m_DeviceFileMinor1));
+
+    const auto reversed = [](std::string str) {
+        std::reverse(str.begin(), str.end());
+        return str;
+    };
+
+    writeToDeviceFile(m_DeviceFileMinor2, boundaryChars);
+
+    QVERIFY(reversed(boundaryChars) == readFromDeviceFile(m_DeviceFileMinor2));
+
+    writeToDeviceFile(m_DeviceFileMinor2, longInput);
+
+    QVERIFY(reversed(longInput) == readFromDeviceFile(m_DeviceFileMinor2));
+
+    writeToDeviceFile(m_DeviceFileMinor2, nonAsciiInput);
+
+    QVERIFY(reversed(nonAsciiInput) == readFromDeviceFile(m_DeviceFileMinor2));
+}
+
 void StringOpsModuleTests::testCombinedReadFromAfterWriteTo()
 {
     writeToDeviceFile(m_DeviceFileMinor1, " Writing to minor number 1\n");
@@ -299,6 +403,239 @@ void StringOpsModuleTests::testCombinedReadFromAfterWriteTo()
     QVERIFY("Minor 3 is \nthe winner!!!; 25" == readFromDeviceFile(m_DeviceFileMinor3));
 }
 
+void StringOpsModuleTests::testConcurrentlyOpenedDeviceFiles()
+{
+    // the minor numbers can be opened at the same time, any number of times
+    const int minor1Fd{open(m_DeviceFileMinor1.c_str(), O_RDWR)};
+    const int minor1ReaderFd{open(m_DeviceFileMinor1.c_str(), O_RDONLY)};
+    const int minor2Fd{open(m_DeviceFileMinor2.c_str(), O_RDWR)};
+
+    QVERIFY(minor1Fd > 0 && minor1ReaderFd > 0 && minor2Fd > 0);
+
+    const std::string firstInput{"First INPUT"};
+    const std::string secondInput{"Second INPUT"};
+
+    QVERIFY(write(minor1Fd, firstInput.c_str(), firstInput.size()) == static_cast<ssize_t>(firstInput.size()));
+    QVERIFY(write(minor2Fd, secondInput.c_str(), secondInput.size()) == static_cast<ssize_t>(secondInput.size()));
+
+    // each file reads from its own position
+    char buffer[maxCharsCountToRead];
+
+    QVERIFY(read(minor1Fd, buffer, 5) == 5 && std::string(buffer, 5) == "first");
+    QVERIFY(read(minor1ReaderFd, buffer, maxCharsCountToRead) == 11 && std::string(buffer, 11) == "first input");
+    QVERIFY(read(minor1Fd, buffer, maxCharsCountToRead) == 6 && std::string(buffer, 6) == " input");
+    QVERIFY(read(minor1Fd, buffer, maxCharsCountToRead) == 0);
+    QVERIFY(read(minor2Fd, buffer, maxCharsCountToRead) == 12 && std::string(buffer, 12) == "TUPNI dnoceS");
+    QVERIFY("Second INPUT" == readFromDeviceFile(m_DeviceFileMinor0));
+
+    // once the content is replaced through another file, the reader starts over with the new content
+    const std::string thirdInput{"THIRD"};
+
+    QVERIFY(lseek(minor1ReaderFd, 6, SEEK_SET) == 6);
+    QVERIFY(write(minor1Fd, thirdInput.c_str(), thirdInput.size()) == static_cast<ssize_t>(thirdInput.size()));
+    QVERIFY(read(minor1ReaderFd, buffer, maxCharsCountToRead) == 5 && std::string(buffer, 5) == "third");
+    QVERIFY(pread(minor1ReaderFd, buffer, maxCharsCountToRead, 2) == 3 && std::string(buffer, 3) == "ird");
+
+    close(minor1Fd);
+    close(minor1ReaderFd);
+    close(minor2Fd);
+}
+
+void StringOpsModuleTests::testPipelines()
+{
+    const int fd{open(m_DeviceFileMinor2.c_str(), O_RDWR)};
+    StringOpsPipeline pipeline{};
+
+    QVERIFY(fd > 0);
+    QVERIFY(ioctl(fd, IOCTL_GET_PIPELINE, &pipeline) == 0);
+    QVERIFY(pipeline.opsCount == 2 && pipeline.ops[0] == pipelineOpTrim && pipeline.ops[1] == pipelineOpReverse);
+
+    // invalid pipelines are rejected
+    const StringOpsPipeline lengthNotLast{2, {pipelineOpAppendLength, pipelineOpReverse}};
+    const StringOpsPipeline conflictingCases{2, {pipelineOpToLowerCase, pipelineOpToUpperCase}};
+    const StringOpsPipeline repeatedOp{2, {pipelineOpReverse, pipelineOpReverse}};
+    const StringOpsPipeline tooManyOps{maxPipelineOpsCount + 1, {}};
+
+    QVERIFY(ioctl(fd, IOCTL_SET_PIPELINE, &lengthNotLast) != 0);
+    QVERIFY(ioctl(fd, IOCTL_SET_PIPELINE, &conflictingCases) != 0);
+    QVERIFY(ioctl(fd, IOCTL_SET_PIPELINE, &repeatedOp) != 0);
+    QVERIFY(ioctl(fd, IOCTL_SET_PIPELINE, &tooManyOps) != 0);
+
+    // all operations applied to the written input
+    const StringOpsPipeline fullPipeline{
+        4, {pipelineOpTrim, pipelineOpToUpperCase, pipelineOpReverse, pipelineOpAppendLength}};
+
+    QVERIFY(ioctl(fd, IOCTL_SET_PIPELINE, &fullPipeline) == 0);
+    QVERIFY(writeToDeviceFile(m_DeviceFileMinor2, "  Pipeline test\n"));
+    QVERIFY("TSET ENILEPIP; 13" == readFromDeviceFile(m_DeviceFileMinor2));
+    QVERIFY("Pipeline test" == readFromDeviceFile(m_DeviceFileMinor0));
+
+    // minor 0 has no pipeline
+    const int minor0Fd{open(m_DeviceFileMinor0.c_str(), O_RDONLY)};
+
+    QVERIFY(minor0Fd > 0);
+    QVERIFY(ioctl(minor0Fd, IOCTL_GET_PIPELINE, &pipeline) != 0);
+
+    close(minor0Fd);
+
+    // the default pipeline is restored (kept by the module until unloaded)
+    const StringOpsPipeline defaultPipeline{2, {pipelineOpTrim, pipelineOpReverse}};
+
+    QVERIFY(ioctl(fd, IOCTL_SET_PIPELINE, &defaultPipeline) == 0);
+
+    close(fd);
+}
+
+void StringOpsModuleTests::testStreamingMode()
+{
+    constexpr size_t chunkSize{4096};
+
+    const int fd{open(m_DeviceFileMinor1.c_str(), O_RDWR)};
+    bool shouldStream{true};
+
+    QVERIFY(fd > 0);
+    QVERIFY(ioctl(fd, IOCTL_ENABLE_STREAMING_MODE, &shouldStream) == 0);
+
+    // the payload exceeds the stream buffer, it gets transformed chunk by chunk
+    std::string payload;
+    std::string output;
+    char buffer[chunkSize];
+
+    for (size_t index = 0; index < 4 * streamBufferSize; ++index)
+    {
+        payload += static_cast<char>('A' + index % 26);
+    }
+
+    for (size_t offset = 0; offset < payload.size(); offset += chunkSize)
+    {
+        QVERIFY(write(fd, payload.c_str() + offset, chunkSize) == static_cast<ssize_t>(chunkSize));
+
+        const ssize_t readCharsCount{read(fd, buffer, chunkSize)};
+
+        QVERIFY(readCharsCount == static_cast<ssize_t>(chunkSize));
+
+        output.append(buffer, readCharsCount);
+    }
+
+    QVERIFY(ioctl(fd, IOCTL_END_STREAM, nullptr) == 0);
+    QVERIFY(read(fd, buffer, chunkSize) == 0);
+
+    std::transform(payload.begin(), payload.end(), payload.begin(), [](char ch) { return std::tolower(ch); });
+
+    QVERIFY(output == payload);
+
+    // a reversed payload is provided only once the stream ended
+    const int reverseFd{open(m_DeviceFileMinor2.c_str(), O_RDWR | O_NONBLOCK)};
+    const std::string reversedPayload{"  Reversed stream payload\n"};
+
+    QVERIFY(reverseFd > 0);
+    QVERIFY(ioctl(reverseFd, IOCTL_ENABLE_STREAMING_MODE, &shouldStream) == 0);
+    QVERIFY(write(reverseFd, reversedPayload.c_str(), reversedPayload.size()) ==
+            static_cast<ssize_t>(reversedPayload.size()));
+    QVERIFY(read(reverseFd, buffer, chunkSize) == -1 && errno == EAGAIN);
+    QVERIFY(ioctl(reverseFd, IOCTL_END_STREAM, nullptr) == 0);
+
+    // the next payload waits until the ended one got read
+    const std::string nextPayload{"Next"};
+
+    QVERIFY(write(reverseFd, nextPayload.c_str(), nextPayload.size()) == -1 && errno == EAGAIN);
+
+    const ssize_t readCharsCount{read(reverseFd, buffer, chunkSize)};
+
+    QVERIFY(readCharsCount > 0 && std::string(buffer, readCharsCount) == "daolyap maerts desreveR");
+    QVERIFY(write(reverseFd, nextPayload.c_str(), nextPayload.size()) == static_cast<ssize_t>(nextPayload.size()));
+
+    shouldStream = false;
+
+    QVERIFY(ioctl(fd, IOCTL_ENABLE_STREAMING_MODE, &shouldStream) == 0);
+    QVERIFY(ioctl(reverseFd, IOCTL_ENABLE_STREAMING_MODE, &shouldStream) == 0);
+
+    close(fd);
+    close(reverseFd);
+}
+
+void StringOpsModuleTests::testBatchTransform()
+{
+    QVERIFY(writeToDeviceFile(m_DeviceFileMinor3, "Before batch"));
+
+    const int fd{open(m_DeviceFileMinor3.c_str(), O_RDWR)};
+
+    QVERIFY(fd > 0);
+
+    // minor 3: trim + append length
+    const std::string firstInput{"  First input \n"};
+    const std::string emptyInput{"   "};
+    const std::string tooLongInput(inputBufferSize, 'a');
+    char firstOutput[32]{};
+    char emptyOutput[32]{};
+    char tooSmallOutput[4]{};
+    char tooLongOutput[32]{};
+
+    StringOpsBatchItem items[]{
+        {firstInput.c_str(), firstInput.size(), firstOutput, sizeof(firstOutput), 0, 0},
+        {emptyInput.c_str(), emptyInput.size(), emptyOutput, sizeof(emptyOutput), 0, 0},
+        {firstInput.c_str(), firstInput.size(), tooSmallOutput, sizeof(tooSmallOutput), 0, 0},
+        {tooLongInput.c_str(), tooLongInput.size(), tooLongOutput, sizeof(tooLongOutput), 0, 0}};
+
+    StringOpsBatch batch{items, 4};
+
+    QVERIFY(ioctl(fd, IOCTL_TRANSFORM_BATCH, &batch) == 0);
+    QVERIFY(items[0].status == 0 && items[0].outputLength == 15 && std::string(firstOutput) == "First input; 11");
+    QVERIFY(items[1].status == 0 && items[1].outputLength == 0 && std::string(emptyOutput).empty());
+    QVERIFY(items[2].status == -ENOSPC && items[2].outputLength == 15);
+    QVERIFY(items[3].status == -E2BIG);
+
+    // the content of the minor number and the last user input are not changed
+    QVERIFY("Before batch; 12" == readFromDeviceFile(m_DeviceFileMinor3));
+    QVERIFY("Before batch" == readFromDeviceFile(m_DeviceFileMinor0));
+
+    // too many items are rejected, minor 0 has no pipeline
+    batch.itemsCount = 1025;
+
+    QVERIFY(ioctl(fd, IOCTL_TRANSFORM_BATCH, &batch) != 0);
+
+    const int minor0Fd{open(m_DeviceFileMinor0.c_str(), O_RDONLY)};
+
+    batch.itemsCount = 1;
+
+    QVERIFY(minor0Fd > 0);
+    QVERIFY(ioctl(minor0Fd, IOCTL_TRANSFORM_BATCH, &batch) != 0);
+
+    close(minor0Fd);
+    close(fd);
+}
+
+void StringOpsModuleTests::testResetMinorNumber()
+{
+    // an empty input is an ordinary write: the content is cleared, the pipeline is kept
+    const int fd{open(m_DeviceFileMinor1.c_str(), O_RDWR)};
+    const StringOpsPipeline upperCasePipeline{1, {pipelineOpToUpperCase}};
+    StringOpsPipeline pipeline{};
+
+    QVERIFY(fd > 0);
+    QVERIFY(ioctl(fd, IOCTL_SET_PIPELINE, &upperCasePipeline) == 0);
+    QVERIFY(writeToDeviceFile(m_DeviceFileMinor1, "Reset test"));
+    QVERIFY("RESET TEST" == readFromDeviceFile(m_DeviceFileMinor1));
+    QVERIFY(writeToDeviceFile(m_DeviceFileMinor1, ""));
+    QVERIFY("" == readFromDeviceFile(m_DeviceFileMinor1));
+    QVERIFY(ioctl(fd, IOCTL_GET_PIPELINE, &pipeline) == 0);
+    QVERIFY(pipeline.opsCount == 1 && pipeline.ops[0] == pipelineOpToUpperCase);
+
+    // resetting restores the default pipeline and clears the content
+    QVERIFY(writeToDeviceFile(m_DeviceFileMinor1, "Reset test"));
+    QVERIFY(ioctl(fd, IOCTL_RESET_MINOR_NUMBER, nullptr) == 0);
+    QVERIFY("" == readFromDeviceFile(m_DeviceFileMinor1));
+    QVERIFY("Reset test" == readFromDeviceFile(m_DeviceFileMinor0));
+    QVERIFY(ioctl(fd, IOCTL_GET_PIPELINE, &pipeline) == 0);
+    QVERIFY(pipeline.opsCount == 2 && pipeline.ops[0] == pipelineOpTrim && pipeline.ops[1] == pipelineOpToLowerCase);
+
+    close(fd);
+
+    // resetting minor 0 clears the last user input
+    QVERIFY(ioctlResetMinorNumber(m_DeviceFileMinor0));
+    QVERIFY("" == readFromDeviceFile(m_DeviceFileMinor0));
+}
+
 void StringOpsModuleTests::initializeSupportedMinorNumbers()
 {
     m_DeviceFileMinor0 = deviceDirPath;
@@ -354,11 +691,25 @@ std::optional<std::string> StringOpsModuleTests::readFromDeviceFile(const std::f
     return Utilities::readStringFromFile(deviceFile, maxCharsCountToRead, TRIM_MODE);
 }
 
+bool StringOpsModuleTests::ioctlResetMinorNumber(const std::filesystem::path& deviceFile)
+{
+    const int fd{open(deviceFile.c_str(), O_RDONLY)};
+    const bool success{fd > 0 && ioctl(fd, IOCTL_RESET_MINOR_NUMBER, nullptr) == 0};
+
+    if (fd > 0)
+    {
+        close(fd);
+    }
+
+    return success;
+}
+
 void StringOpsModuleTests::resetKernelModule()
 {
-    writeToDeviceFile(m_DeviceFileMinor1, "");
-    writeToDeviceFile(m_DeviceFileMinor2, "");
-    writeToDeviceFile(m_DeviceFileMinor3, "");
+    ioctlResetMinorNumber(m_DeviceFileMinor0);
+    ioctlResetMinorNumber(m_DeviceFileMinor1);
+    ioctlResetMinorNumber(m_DeviceFileMinor2);
+    ioctlResetMinorNumber(m_DeviceFileMinor3);
 }
 
 bool StringOpsModuleTests::isKernelModuleReset()
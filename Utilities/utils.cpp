@@ -77,13 +77,13 @@ std::string trimAndConvertToStdString(const char* str)
 } // namespace
 } // namespace Utilities
 
-void Utilities::loadKernelModule(const std::filesystem::path& kernelModulePath)
+void Utilities::loadKernelModule(const std::filesystem::path& kernelModulePath, const std::string& moduleParameters)
 {
     if (std::filesystem::exists(kernelModulePath) && std::filesystem::is_regular_file(kernelModulePath))
     {
         // no need to include sudo in the command string -> the user needs to run the app with sudo anyway and if so the
         // command will be executed in sudo mode
-        const std::string loadCommand{"insmod " + kernelModulePath.string() + " 2> /dev/null"};
+        const std::string loadCommand{"insmod " + kernelModulePath.string() + " " + moduleParameters + " 2> /dev/null"};
         executeCommand(loadCommand, READ_MODE);
     }
 }
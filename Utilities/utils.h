@@ -13,7 +13,8 @@
 
 namespace Utilities
 {
-void loadKernelModule(const std::filesystem::path& kernelModulePath);
+void loadKernelModule(const std::filesystem::path& kernelModulePath,
+                      const std::string& moduleParameters = ""); // e.g. "param1=value1 param2=value2"
 void unloadKernelModule(const std::string_view kernelModuleName);
 bool isKernelModuleLoaded(const std::string_view kernelModuleName);
 